@@ -0,0 +1,76 @@
+#include "blockcompressor.h"
+#include <QtEndian>
+#include <QDebug>
+
+#if defined(CSV_HAVE_LZ4)
+#include <lz4.h>
+#endif
+
+#if defined(CSV_HAVE_LZ4)
+
+// 格式：4字节小端原始长度 + LZ4块
+QByteArray BlockCompressor::compress(const QByteArray &data)
+{
+    if (data.isEmpty() || data.size() > LZ4_MAX_INPUT_SIZE) {
+        return QByteArray();
+    }
+    QByteArray result(int(sizeof(quint32)) + LZ4_compressBound(int(data.size())), Qt::Uninitialized);
+    qToLittleEndian<quint32>(static_cast<quint32>(data.size()), result.data());
+    const int compressed = LZ4_compress_default(data.constData(), result.data() + sizeof(quint32),
+                                                int(data.size()), int(result.size()) - int(sizeof(quint32)));
+    if (compressed <= 0) {
+        return QByteArray();
+    }
+    result.truncate(int(sizeof(quint32)) + compressed);
+    result.squeeze();
+    return result;
+}
+
+QByteArray BlockCompressor::decompress(const QByteArray &data)
+{
+    if (data.size() <= int(sizeof(quint32))) {
+        return QByteArray();
+    }
+    const quint32 rawSize = qFromLittleEndian<quint32>(data.constData());
+    if (rawSize == 0 || rawSize > quint32(LZ4_MAX_INPUT_SIZE)) {
+        return QByteArray();
+    }
+    QByteArray result(int(rawSize), Qt::Uninitialized);
+    const int decompressed = LZ4_decompress_safe(data.constData() + sizeof(quint32), result.data(),
+                                                 int(data.size()) - int(sizeof(quint32)), int(result.size()));
+    if (decompressed != result.size()) {
+        qDebug() << "LZ4解压失败:" << decompressed;
+        return QByteArray();
+    }
+    return result;
+}
+
+QString BlockCompressor::implementationName()
+{
+    return QStringLiteral("LZ4");
+}
+
+#else
+
+QByteArray BlockCompressor::compress(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return QByteArray();
+    }
+    return qCompress(data, 1); // 最低级别，压缩速度优先
+}
+
+QByteArray BlockCompressor::decompress(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return QByteArray();
+    }
+    return qUncompress(data);
+}
+
+QString BlockCompressor::implementationName()
+{
+    return QStringLiteral("zlib");
+}
+
+#endif
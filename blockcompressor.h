@@ -0,0 +1,34 @@
+#ifndef BLOCKCOMPRESSOR_H
+#define BLOCKCOMPRESSOR_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @brief 内存中数据块的快速压缩，用于行块缓存的冷层
+ *
+ * 构建时找到LZ4库（定义CSV_HAVE_LZ4）则使用LZ4，解压速度远高于从磁盘重新读取；
+ * 否则退回Qt自带的zlib（qCompress，最低压缩级别）。压缩结果只在本进程内使用，不写入磁盘。
+ */
+namespace BlockCompressor {
+
+/**
+ * @brief 压缩一段数据
+ * @return 压缩结果（带原始长度），输入为空时返回空
+ */
+QByteArray compress(const QByteArray &data);
+
+/**
+ * @brief 解压compress的结果
+ * @return 原始数据，数据损坏时返回空
+ */
+QByteArray decompress(const QByteArray &data);
+
+/**
+ * @brief 当前使用的压缩实现名称（"LZ4"/"zlib"）
+ */
+QString implementationName();
+
+}
+
+#endif // BLOCKCOMPRESSOR_H
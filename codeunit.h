@@ -0,0 +1,44 @@
+#ifndef CODEUNIT_H
+#define CODEUNIT_H
+
+#include <QtGlobal>
+
+/**
+ * @brief 文件文本的码元宽度和字节序
+ *
+ * UTF-8、GBK等编码中分隔符、引号、换行符都是单字节，直接按字节扫描；
+ * UTF-16中这些字符各占两个字节，且0x0A、0x22等字节可能是其他字符的一半，必须按对齐的码元扫描。
+ * 所有偏移和长度仍以字节为单位。
+ */
+enum class CodeUnit {
+    Byte,
+    Utf16LE,
+    Utf16BE
+};
+
+inline int codeUnitSize(CodeUnit unit)
+{
+    return unit == CodeUnit::Byte ? 1 : 2;
+}
+
+// 读取p处的一个码元
+inline quint16 loadCodeUnit(const char *p, CodeUnit unit)
+{
+    const uchar *u = reinterpret_cast<const uchar *>(p);
+    switch (unit) {
+    case CodeUnit::Utf16LE:
+        return static_cast<quint16>(u[0] | (u[1] << 8));
+    case CodeUnit::Utf16BE:
+        return static_cast<quint16>((u[0] << 8) | u[1]);
+    default:
+        return u[0];
+    }
+}
+
+// 把文件偏移向下对齐到码元边界，写了一半的码元留到下次处理
+inline qint64 alignToCodeUnit(qint64 offset, CodeUnit unit)
+{
+    return offset - offset % codeUnitSize(unit);
+}
+
+#endif // CODEUNIT_H
@@ -0,0 +1,102 @@
+#include "cpufeatures.h"
+
+#if defined(CSV_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace {
+
+struct Features {
+    bool sse2 = false;
+    bool sse42 = false;
+    bool popcnt = false;
+    bool avx2 = false;
+    bool avx512bw = false;
+    bool pclmul = false;
+};
+
+Features detectFeatures()
+{
+    Features features;
+    // 设置了环境变量CSV_FORCE_SCALAR时不启用任何SIMD路径，用来与向量化实现对照（见tests/）
+    if (qEnvironmentVariableIsSet("CSV_FORCE_SCALAR")) {
+        return features;
+    }
+#if defined(CSV_SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    features.sse2 = (info[3] & (1 << 26)) != 0;
+    features.pclmul = (info[2] & (1 << 1)) != 0;
+    features.sse42 = (info[2] & (1 << 20)) != 0;
+    features.popcnt = (info[2] & (1 << 23)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    // XCR0的第1、2位表示操作系统会保存XMM/YMM寄存器，第5~7位表示会保存掩码寄存器和ZMM寄存器
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    const bool ymmEnabled = (xcr0 & 0x6) == 0x6;
+    const bool zmmEnabled = (xcr0 & 0xE6) == 0xE6;
+
+    if (maxLeaf >= 7) {
+        __cpuidex(info, 7, 0);
+        features.avx2 = avx && ymmEnabled && (info[1] & (1 << 5)) != 0;
+        // AVX512F(第16位)和AVX512BW(第30位)
+        features.avx512bw = zmmEnabled && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2");
+    features.sse42 = __builtin_cpu_supports("sse4.2");
+    features.popcnt = __builtin_cpu_supports("popcnt");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.avx512bw = __builtin_cpu_supports("avx512bw");
+    features.pclmul = __builtin_cpu_supports("pclmul");
+#endif
+#endif
+    return features;
+}
+
+const Features &features()
+{
+    static const Features cached = detectFeatures();
+    return cached;
+}
+
+}
+
+namespace CpuFeatures {
+
+bool hasSse2()
+{
+    return features().sse2;
+}
+
+bool hasSse42()
+{
+    return features().sse42;
+}
+
+bool hasPopcnt()
+{
+    return features().popcnt;
+}
+
+bool hasAvx2()
+{
+    return features().avx2;
+}
+
+bool hasAvx512bw()
+{
+    return features().avx512bw;
+}
+
+bool hasPclmul()
+{
+    return features().pclmul;
+}
+
+}
@@ -0,0 +1,58 @@
+#ifndef CPUFEATURES_H
+#define CPUFEATURES_H
+
+#include <QtGlobal>
+
+// 只有x86/x64平台才编译SIMD代码路径，其余平台全部走标量实现
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CSV_SIMD_X86 1
+#endif
+
+// GCC/Clang(含MinGW)通过target属性为单个函数开启指令集，MSVC无需额外标记即可使用内建函数
+#if defined(CSV_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CSV_TARGET(arch) __attribute__((target(arch)))
+#else
+#define CSV_TARGET(arch)
+#endif
+
+/**
+ * @brief 运行时CPU指令集检测
+ *
+ * 检测结果在首次调用时缓存，之后的调用只是读取静态变量。
+ * 非x86平台上，或设置了环境变量CSV_FORCE_SCALAR时，所有函数都返回false。
+ */
+namespace CpuFeatures {
+
+/**
+ * @brief 是否支持SSE2
+ */
+bool hasSse2();
+
+/**
+ * @brief 是否支持SSE4.2
+ */
+bool hasSse42();
+
+/**
+ * @brief 是否支持POPCNT指令
+ */
+bool hasPopcnt();
+
+/**
+ * @brief 是否支持AVX2（同时检查操作系统是否保存YMM寄存器）
+ */
+bool hasAvx2();
+
+/**
+ * @brief 是否支持AVX-512BW（同时检查操作系统是否保存ZMM和掩码寄存器）
+ */
+bool hasAvx512bw();
+
+/**
+ * @brief 是否支持PCLMULQDQ无进位乘法指令
+ */
+bool hasPclmul();
+
+}
+
+#endif // CPUFEATURES_H
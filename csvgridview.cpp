@@ -0,0 +1,458 @@
+#include "csvgridview.h"
+#include "tablemodel.h"
+#include <QElapsedTimer>
+#include <QHeaderView>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QStyle>
+#include <QWheelEvent>
+
+// 行号栏，绘制交给CsvGridView，与单元格区域使用同一个行高和像素偏移
+class CsvGridView::RowNumberArea : public QWidget
+{
+public:
+    explicit RowNumberArea(CsvGridView *view)
+        : QWidget(view)
+        , m_view(view)
+    {
+    }
+
+protected:
+    void paintEvent(QPaintEvent *event) override
+    {
+        m_view->paintRowNumbers(event);
+    }
+
+private:
+    CsvGridView *m_view;
+};
+
+CsvGridView::CsvGridView(QWidget *parent)
+    : QAbstractScrollArea(parent)
+    , m_model(nullptr)
+    , m_horizontalHeader(new QHeaderView(Qt::Horizontal, this))
+    , m_rowNumberArea(new RowNumberArea(this))
+    , m_rowHeight(25)
+    , m_rowNumberDigits(0)
+    , m_pixelOffset(0)
+    , m_atTop(true)
+    , m_atBottom(false)
+    , m_pendingPixels(0)
+{
+    // 单元格区域每次都完整填充背景，Qt不必先擦除；不透明的视口才能用QWidget::scroll平移已绘制的内容
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+    m_horizontalHeader->setSectionsClickable(false);
+    m_horizontalHeader->setHighlightSections(false);
+    connect(m_horizontalHeader, &QHeaderView::sectionResized, this, [this]() {
+        updateGeometries();
+        viewport()->update();
+    });
+    connect(m_horizontalHeader, &QHeaderView::sectionCountChanged, this, &CsvGridView::updateGeometries);
+
+    m_smoothTimer.setInterval(SmoothFrameMs);
+    connect(&m_smoothTimer, &QTimer::timeout, this, &CsvGridView::onSmoothScrollTick);
+    updateGeometries();
+}
+
+void CsvGridView::setModel(TableModel *model)
+{
+    if (m_model) {
+        disconnect(m_model, nullptr, this, nullptr);
+    }
+    m_model = model;
+    m_horizontalHeader->setModel(model);
+    if (m_model) {
+        connect(m_model, &TableModel::visibleWindowMoved, this, &CsvGridView::onVisibleWindowMoved);
+        connect(m_model, &QAbstractItemModel::modelReset, this, &CsvGridView::onModelReset);
+        connect(m_model, &QAbstractItemModel::dataChanged, this, &CsvGridView::onDataChanged);
+    }
+    onModelReset();
+}
+
+TableModel *CsvGridView::model() const
+{
+    return m_model;
+}
+
+QHeaderView *CsvGridView::horizontalHeader() const
+{
+    return m_horizontalHeader;
+}
+
+void CsvGridView::setRowHeight(int height)
+{
+    m_rowHeight = qMax(1, height);
+    m_pixelOffset = qMin(m_pixelOffset, m_rowHeight - 1);
+    viewport()->update();
+    m_rowNumberArea->update();
+}
+
+int CsvGridView::rowHeight() const
+{
+    return m_rowHeight;
+}
+
+QModelIndex CsvGridView::indexAt(const QPoint &pos) const
+{
+    if (!m_model || pos.y() < 0) {
+        return QModelIndex();
+    }
+    const int column = m_horizontalHeader->logicalIndexAt(pos.x());
+    if (column < 0) {
+        return QModelIndex();
+    }
+    return m_model->index((pos.y() + m_pixelOffset) / m_rowHeight, column);
+}
+
+int CsvGridView::pixelOffset() const
+{
+    return m_pixelOffset;
+}
+
+void CsvGridView::setScrollBounds(bool atTop, bool atBottom)
+{
+    m_atTop = atTop;
+    m_atBottom = atBottom;
+    if (m_atBottom) {
+        setPixelOffset(0);
+    }
+}
+
+GridFrameStats CsvGridView::frameStats() const
+{
+    return m_frameStats;
+}
+
+void CsvGridView::resetFrameStats()
+{
+    m_frameStats = GridFrameStats();
+}
+
+int CsvGridView::availableRows() const
+{
+    if (!m_model) {
+        return 0;
+    }
+    return int(m_model->getFullDataSize() - m_model->getVisiableStartRow());
+}
+
+void CsvGridView::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QPainter painter(viewport());
+    const QRect area = event->rect();
+    painter.fillRect(area, palette().color(QPalette::Base));
+    const int cells = paintCells(painter, area);
+
+    recordFrame(timer.nsecsElapsed(), cells);
+}
+
+int CsvGridView::paintCells(QPainter &painter, const QRect &area)
+{
+    if (!m_model || m_horizontalHeader->count() == 0) {
+        return 0;
+    }
+
+    // 与重绘区域相交的行（可视区域中的行号）；有像素偏移时底部露出的行取自完整数据中已有的后续行
+    const int firstRow = qMax(0, (area.top() + m_pixelOffset) / m_rowHeight);
+    const int lastRow = qMin((area.bottom() + m_pixelOffset) / m_rowHeight, availableRows() - 1);
+    if (lastRow < firstRow) {
+        return 0;
+    }
+    int firstVisual = m_horizontalHeader->visualIndexAt(area.left());
+    int lastVisual = m_horizontalHeader->visualIndexAt(area.right());
+    if (firstVisual < 0) {
+        firstVisual = 0;
+    }
+    if (lastVisual < 0) {
+        lastVisual = m_horizontalHeader->count() - 1;
+    }
+
+    // 每行只在RowWindow中查找一次所在的块，之后按列绘制
+    struct RowRef {
+        const RowBlock *block;
+        int row;
+    };
+    const RowWindow &rows = m_model->getFullData();
+    const int visibleStart = int(m_model->getVisiableStartRow());
+    QVector<RowRef> refs(lastRow - firstRow + 1);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        RowRef &ref = refs[row - firstRow];
+        ref.block = &rows.blockAt(visibleStart + row, &ref.row);
+    }
+    // 高亮行按全局行号（从1开始）保存
+    const qint64 firstGlobalRow = m_model->getFullDataStartRow() + visibleStart + 1;
+
+    const QFontMetrics metrics = viewport()->fontMetrics();
+    const int baseline = (m_rowHeight + metrics.ascent() - metrics.descent()) / 2;
+    const QPen textPen(palette().color(QPalette::Text));
+    QVector<QLine> gridLines;
+    int cells = 0;
+    for (int visual = firstVisual; visual <= lastVisual; ++visual) {
+        const int column = m_horizontalHeader->logicalIndex(visual);
+        if (m_horizontalHeader->isSectionHidden(column)) {
+            continue;
+        }
+        const int left = m_horizontalHeader->sectionViewportPosition(column);
+        const int width = m_horizontalHeader->sectionSize(column);
+        const int source = m_model->sourceColumn(column);
+        // 超出列宽的文字由列的裁剪区域截断，不逐格计算省略
+        painter.setClipRect(QRect(left, area.top(), width - 1, area.height()));
+        painter.setPen(textPen);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            const RowRef &ref = refs.at(row - firstRow);
+            const int top = row * m_rowHeight - m_pixelOffset;
+            const QColor background = m_model->highlightColor(firstGlobalRow + row, source);
+            if (background.isValid()) {
+                painter.fillRect(QRect(left, top, width, m_rowHeight), background);
+            }
+            ++cells;
+            if (!ref.block->hasField(ref.row, source)) {
+                continue; // 该行列数不足，或读取时该列不在列投影中
+            }
+            m_decoder.setEncoding(ref.block->encoding());
+            painter.drawText(left + CellMargin, top + baseline, ref.block->field(ref.row, source, m_decoder));
+        }
+        gridLines.append(QLine(left + width - 1, area.top(), left + width - 1, area.bottom()));
+    }
+    painter.setClipping(false);
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        const int y = (row + 1) * m_rowHeight - m_pixelOffset - 1;
+        gridLines.append(QLine(area.left(), y, area.right(), y));
+    }
+    painter.setPen(gridColor());
+    painter.drawLines(gridLines);
+    return cells;
+}
+
+void CsvGridView::paintRowNumbers(QPaintEvent *event)
+{
+    QPainter painter(m_rowNumberArea);
+    const QRect area = event->rect();
+    painter.fillRect(area, palette().color(QPalette::Button));
+
+    const int width = m_rowNumberArea->width();
+    const int firstRow = qMax(0, (area.top() + m_pixelOffset) / m_rowHeight);
+    const int lastRow = qMin((area.bottom() + m_pixelOffset) / m_rowHeight, availableRows() - 1);
+    if (m_model) {
+        // 与TableModel::headerData的垂直表头一致
+        const qint64 firstNumber = m_model->getCurrentWindowStartRow();
+        painter.setPen(palette().color(QPalette::ButtonText));
+        for (int row = firstRow; row <= lastRow; ++row) {
+            const QRect cell(0, row * m_rowHeight - m_pixelOffset, width - CellMargin, m_rowHeight);
+            painter.drawText(cell, Qt::AlignRight | Qt::AlignVCenter, QString::number(firstNumber + row));
+        }
+    }
+
+    painter.setPen(gridColor());
+    painter.drawLine(width - 1, area.top(), width - 1, area.bottom());
+    for (int row = firstRow; row <= lastRow; ++row) {
+        const int y = (row + 1) * m_rowHeight - m_pixelOffset - 1;
+        painter.drawLine(area.left(), y, area.right(), y);
+    }
+}
+
+int CsvGridView::rowNumberDigits() const
+{
+    const qint64 lastNumber = m_model ? m_model->getCurrentWindowStartRow() + availableRows() : 0;
+    return qMax(4, int(QString::number(lastNumber).size()));
+}
+
+QColor CsvGridView::gridColor() const
+{
+    // 与QTableView的网格线颜色相同
+    return QColor::fromRgba(static_cast<QRgb>(style()->styleHint(QStyle::SH_Table_GridLineColor, nullptr, this)));
+}
+
+void CsvGridView::updateGeometries()
+{
+    m_rowNumberDigits = rowNumberDigits();
+    const int numberWidth = fontMetrics().horizontalAdvance(QString(m_rowNumberDigits, QLatin1Char('9'))) + 2 * CellMargin;
+    const int headerHeight = m_horizontalHeader->sizeHint().height();
+    setViewportMargins(numberWidth, headerHeight, 0, 0);
+
+    const QRect viewportRect = viewport()->geometry();
+    m_horizontalHeader->setGeometry(viewportRect.left(), viewportRect.top() - headerHeight,
+                                    viewportRect.width(), headerHeight);
+    m_rowNumberArea->setGeometry(viewportRect.left() - numberWidth, viewportRect.top(),
+                                 numberWidth, viewportRect.height());
+
+    horizontalScrollBar()->setRange(0, qMax(0, m_horizontalHeader->length() - viewportRect.width()));
+    horizontalScrollBar()->setPageStep(viewportRect.width());
+    horizontalScrollBar()->setSingleStep(m_horizontalHeader->defaultSectionSize() / 4);
+}
+
+void CsvGridView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateGeometries();
+}
+
+void CsvGridView::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dy); // 纵向由外部滚动条和像素偏移控制，本视图的纵向滚动条不使用
+    m_horizontalHeader->setOffset(horizontalScrollBar()->value());
+    viewport()->scroll(dx, 0);
+}
+
+void CsvGridView::scrollVertically(int dy)
+{
+    if (dy == 0) {
+        return;
+    }
+    if (qAbs(dy) >= viewport()->height()) {
+        viewport()->update();
+        m_rowNumberArea->update();
+    } else {
+        // 已绘制的内容整体平移，只为新露出的区域产生绘制事件
+        viewport()->scroll(0, dy);
+        m_rowNumberArea->scroll(0, dy);
+    }
+}
+
+void CsvGridView::onVisibleWindowMoved(int rows)
+{
+    if (rowNumberDigits() > m_rowNumberDigits) {
+        // 行号位数增加，行号栏加宽后单元格区域的位置也变了
+        updateGeometries();
+        viewport()->update();
+        m_rowNumberArea->update();
+        return;
+    }
+    scrollVertically(-rows * m_rowHeight);
+}
+
+void CsvGridView::onModelReset()
+{
+    // 换了数据（跳转、大范围滚动、重新读取）时从整行开始显示
+    m_smoothTimer.stop();
+    m_pendingPixels = 0;
+    m_pixelOffset = 0;
+    updateGeometries();
+    viewport()->update();
+    m_rowNumberArea->update();
+}
+
+void CsvGridView::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (!m_model || !topLeft.isValid() || !bottomRight.isValid()) {
+        viewport()->update();
+        m_rowNumberArea->update();
+        return;
+    }
+    // 变化到最后一个可视行时，底部露出的后续行也可能刚有数据，一直重绘到视口底部
+    const int top = topLeft.row() * m_rowHeight - m_pixelOffset;
+    const int bottom = bottomRight.row() >= m_model->rowCount() - 1
+                           ? viewport()->height()
+                           : (bottomRight.row() + 1) * m_rowHeight - m_pixelOffset;
+    viewport()->update(QRect(0, top, viewport()->width(), bottom - top));
+    m_rowNumberArea->update(QRect(0, top, m_rowNumberArea->width(), bottom - top));
+}
+
+void CsvGridView::setPixelOffset(int offset)
+{
+    offset = qBound(0, offset, m_rowHeight - 1);
+    if (offset == m_pixelOffset) {
+        return;
+    }
+    const int dy = m_pixelOffset - offset;
+    m_pixelOffset = offset;
+    scrollVertically(dy);
+}
+
+void CsvGridView::scrollByPixels(int delta)
+{
+    if (availableRows() <= 0) {
+        return;
+    }
+    int total = m_pixelOffset + delta;
+    if (m_atTop && total < 0) {
+        total = 0;
+    }
+    if (m_atBottom && delta > 0) {
+        total = m_pixelOffset;
+    }
+    // 向下取整到整行，余数为新的像素偏移；先平移余数，外部滚动条移动整行时模型再平移整行
+    const int rows = total >= 0 ? total / m_rowHeight : -((m_rowHeight - 1 - total) / m_rowHeight);
+    setPixelOffset(total - rows * m_rowHeight);
+    if (rows != 0) {
+        emit rowsScrolled(rows);
+    }
+}
+
+void CsvGridView::wheelEvent(QWheelEvent *event)
+{
+    // 触控板给出像素增量，直接跟随；滚轮每格（120）滚动一行，分几帧滚完
+    const int pixels = -event->pixelDelta().y();
+    if (pixels != 0) {
+        m_smoothTimer.stop();
+        m_pendingPixels = 0;
+        scrollByPixels(pixels);
+        event->accept();
+        return;
+    }
+    const int steps = -event->angleDelta().y();
+    if (steps == 0) {
+        QAbstractScrollArea::wheelEvent(event); // 水平滚动
+        return;
+    }
+    m_pendingPixels += steps * m_rowHeight / 120;
+    if (!m_smoothTimer.isActive()) {
+        onSmoothScrollTick();
+        m_smoothTimer.start();
+    }
+    event->accept();
+}
+
+void CsvGridView::onSmoothScrollTick()
+{
+    if (m_pendingPixels == 0) {
+        m_smoothTimer.stop();
+        return;
+    }
+    int step = m_pendingPixels / SmoothDivisor;
+    if (step == 0) {
+        step = m_pendingPixels > 0 ? 1 : -1;
+    }
+    m_pendingPixels -= step;
+    scrollByPixels(step);
+    // 到达两端后剩余的距离作废
+    if ((m_atTop && m_pixelOffset == 0 && m_pendingPixels < 0) || (m_atBottom && m_pendingPixels > 0)) {
+        m_pendingPixels = 0;
+    }
+}
+
+void CsvGridView::keyPressEvent(QKeyEvent *event)
+{
+    switch (event->key()) {
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+    case Qt::Key_PageUp:
+    case Qt::Key_PageDown:
+    case Qt::Key_Home:
+    case Qt::Key_End:
+        // 纵向导航交给主窗口，由外部滚动条处理
+        event->ignore();
+        break;
+    default:
+        QAbstractScrollArea::keyPressEvent(event); // 左右方向键水平滚动
+        break;
+    }
+}
+
+void CsvGridView::recordFrame(qint64 nsecs, int cells)
+{
+    m_frameStats.lastFrameNs = nsecs;
+    m_frameStats.lastCells = cells;
+    m_frameStats.frames++;
+    if (nsecs > m_frameStats.slowestFrameNs) {
+        m_frameStats.slowestFrameNs = nsecs;
+        m_frameStats.slowestCells = cells;
+    }
+    emit frameRendered(m_frameStats);
+}
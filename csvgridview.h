@@ -0,0 +1,114 @@
+#ifndef CSVGRIDVIEW_H
+#define CSVGRIDVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QModelIndex>
+#include <QTimer>
+#include "textdecoder.h"
+
+class QHeaderView;
+class TableModel;
+
+// 单元格区域的绘制耗时，每次绘制后由frameRendered发出
+struct GridFrameStats {
+    qint64 lastFrameNs = 0;    // 最近一帧的绘制耗时（纳秒）
+    int lastCells = 0;         // 最近一帧绘制的单元格数
+    qint64 slowestFrameNs = 0; // resetFrameStats之后最慢的一帧
+    int slowestCells = 0;
+    int frames = 0;            // resetFrameStats之后的帧数
+};
+
+/**
+ * @class CsvGridView
+ * @brief CsvViewer的表格视图，直接从TableModel的行块绘制可视单元格
+ *
+ * 单元格不经过data()和QVariant：绘制时每行在RowWindow中查找一次所在的行块，之后按列裁剪、
+ * 由RowBlock直接解码并绘制，不为单元格构造样式选项或委托。列宽和列标题由QHeaderView管理，行号栏由本视图绘制。
+ * 可视区域在完整数据中移动时（TableModel::visibleWindowMoved）用QWidget::scroll平移已绘制的内容，
+ * 只有新露出的行产生绘制事件。纵向按像素滚动：不足一行的部分保存为第一行的像素偏移，累计满一行时发出rowsScrolled，
+ * 由外部滚动条移动相应的行数；滚轮的每一格分几帧滚完。每次绘制的耗时记录在frameStats中。
+ */
+class CsvGridView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit CsvGridView(QWidget *parent = nullptr);
+
+    void setModel(TableModel *model);
+    TableModel *model() const;
+    QHeaderView *horizontalHeader() const;
+
+    /**
+     * @brief 统一的行高（像素），行数由视口高度和行高决定
+     */
+    void setRowHeight(int height);
+    int rowHeight() const;
+
+    /**
+     * @brief 视口坐标处的单元格，行号为可视区域中的行号，超出可视行数或列数时返回无效索引
+     */
+    QModelIndex indexAt(const QPoint &pos) const;
+
+    /**
+     * @brief 第一行向上移出视口的像素数（0 ~ 行高-1）
+     */
+    int pixelOffset() const;
+
+    /**
+     * @brief 外部滚动条是否已到两端：到顶时不再向上滚动，到底时不保留像素偏移
+     */
+    void setScrollBounds(bool atTop, bool atBottom);
+
+    GridFrameStats frameStats() const;
+    void resetFrameStats();
+
+signals:
+    void rowsScrolled(int rows); // 像素滚动累计满rows行（正数向下），外部滚动条应移动相应的行数
+    void frameRendered(const GridFrameStats &stats); // 单元格区域绘制完一帧
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private slots:
+    void onVisibleWindowMoved(int rows); // 平移已绘制的内容rows行
+    void onModelReset();
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void onSmoothScrollTick(); // 滚完一部分剩余的滚轮距离
+    void updateGeometries(); // 重新放置表头和行号栏，更新水平滚动条的范围
+
+private:
+    class RowNumberArea;
+
+    TableModel *m_model;
+    QHeaderView *m_horizontalHeader;
+    RowNumberArea *m_rowNumberArea;
+    TextDecoder m_decoder;   // 单元格解码器，编码随行块设置
+    int m_rowHeight;
+    int m_rowNumberDigits;   // 行号栏按此位数确定宽度，行号位数增加时才加宽
+    int m_pixelOffset;       // 第一行向上移出视口的像素数
+    bool m_atTop;            // 外部滚动条是否在顶端
+    bool m_atBottom;         // 外部滚动条是否在底端
+    int m_pendingPixels;     // 滚轮尚未滚完的像素数（正数向下）
+    QTimer m_smoothTimer;    // 平滑滚动的帧定时器
+    GridFrameStats m_frameStats;
+    static constexpr int SmoothFrameMs = 16;
+    static constexpr int SmoothDivisor = 3; // 每帧滚动剩余距离的1/3
+    static constexpr int CellMargin = 4;    // 单元格文字与左边框的距离
+
+    int availableRows() const; // 从可视区域第一行起完整数据中已有的行数（可多于可视行数）
+    int paintCells(QPainter &painter, const QRect &area); // 绘制与area相交的单元格，返回单元格数
+    void paintRowNumbers(QPaintEvent *event);
+    int rowNumberDigits() const; // 当前显示的最大行号的位数
+    QColor gridColor() const;
+    void scrollVertically(int dy); // 单元格区域和行号栏一起平移dy像素，超过一屏时整体重绘
+    void setPixelOffset(int offset);
+    void scrollByPixels(int delta); // 按像素滚动，满一行的部分交给外部滚动条
+    void recordFrame(qint64 nsecs, int cells);
+};
+
+#endif // CSVGRIDVIEW_H
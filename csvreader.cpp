@@ -1,14 +1,52 @@
 #include "csvreader.h"
+#include "rowindexer.h"
+#include "indexcache.h"
+#include "csvtokenizer.h"
+#include "textdecoder.h"
+#include "blockcompressor.h"
+#include "rowblockpool.h"
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
+#include <QLoggingCategory>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QtMath>
+#include <QFileInfo>
+#include <algorithm>
+
+// 读取路径上的诊断日志默认关闭，调试时用 QT_LOGGING_RULES="csvviewer.reader.debug=true" 打开
+Q_LOGGING_CATEGORY(lcCsvReader, "csvviewer.reader", QtInfoMsg)
 
 CsvReader::CsvReader(QObject *parent)
     : QObject{parent}
     , m_FileName("")
     , m_encoding(Encoding::AutoDetect) // 默认自动检测编码
+    , m_indexMemoryBudget(128LL * 1024 * 1024) // 默认128MB，约3千万行内保持逐行精确偏移
+    , m_indexThread(nullptr)
+    , m_backgroundIndexing(false)
+    , m_indexGeneration(0)
+    , m_sampledRowsPerByte(0.0)
+    , m_estimateError(1.0)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_followTimer(new QTimer(this))
+    , m_followMode(false)
+    , m_indexedSize(0)
+    , m_tailInQuotes(false)
+    , m_readInterrupted(false)
 {
+    // 写日志的程序往往连续多次写入，合并后再增量索引
+    m_followTimer->setSingleShot(true);
+    m_followTimer->setInterval(FollowDebounceMs);
+    connect(m_followTimer, &QTimer::timeout, this, &CsvReader::checkFileGrowth);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, m_followTimer, qOverload<>(&QTimer::start));
+    // 轮转时旧文件被移走、新文件被创建，只有目录监视能收到新文件出现的通知
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_followTimer, qOverload<>(&QTimer::start));
+}
 
+CsvReader::~CsvReader()
+{
+    stopIndexing();
 }
 
 void CsvReader::setEncoding(Encoding encoding)
@@ -21,6 +59,57 @@ Encoding CsvReader::getEncoding() const
     return m_encoding;
 }
 
+void CsvReader::setIndexMemoryBudget(qint64 bytes)
+{
+    m_indexMemoryBudget = bytes;
+}
+
+void CsvReader::cancelRequestsBefore(quint64 generation)
+{
+    // 只增不减：界面线程按顺序发出请求，较晚的代数总是较大
+    quint64 current = m_latestGeneration.loadAcquire();
+    while (generation > current && !m_latestGeneration.testAndSetOrdered(current, generation, current)) {
+    }
+    // 等待通道空位的结果可能刚刚作废
+    QMutexLocker locker(&m_resultsMutex);
+    m_resultsSpace.wakeAll();
+}
+
+bool CsvReader::isStale(quint64 generation) const
+{
+    return generation != 0 && generation < m_latestGeneration.loadAcquire();
+}
+
+bool CsvReader::shouldStopRead(quint64 generation, ReadPriority priority)
+{
+    if (isStale(generation) || m_scheduler.hasWaitingAbove(priority)) {
+        m_readInterrupted = true;
+    }
+    return m_readInterrupted;
+}
+
+void CsvReader::submitRead(qint64 startRow, qint64 rowCount, quint64 generation, ReadPriority priority,
+                           const QVector<int> &projection)
+{
+    ReadRequest request;
+    request.startRow = startRow;
+    request.rowCount = rowCount;
+    request.generation = generation;
+    request.priority = priority;
+    request.projection = projection;
+    m_scheduler.submit(request);
+    // 唤醒工作线程；执行中的低优先级读取会在下一次读取前发现这个请求并让出
+    QMetaObject::invokeMethod(this, &CsvReader::processReadQueue, Qt::QueuedConnection);
+}
+
+void CsvReader::processReadQueue()
+{
+    ReadRequest request;
+    if (m_scheduler.takeNext(&request)) {
+        executeRead(request);
+    }
+}
+
 void CsvReader::startTiming(const QString &operation)
 {
     m_timer.start();
@@ -47,15 +136,46 @@ Encoding CsvReader::detectEncoding(const QByteArray& data) const
         return Encoding::UTF8;
     }
     
+    // UTF-16 BOM
+    if (data.startsWith(QByteArray("\xFF\xFE", 2))) {
+        return Encoding::UTF16LE;
+    }
+    if (data.startsWith(QByteArray("\xFE\xFF", 2))) {
+        return Encoding::UTF16BE;
+    }
+    
+    // 没有BOM的UTF-16：CSV中ASCII字符占多数，零字节集中在奇数位置(LE)或偶数位置(BE)；
+    // UTF-8和GBK文本中不会出现零字节
+    const int probeSize = qMin(data.size(), 4096) & ~1;
+    int evenZeros = 0;
+    int oddZeros = 0;
+    for (int i = 0; i < probeSize; i += 2) {
+        evenZeros += data[i] == '\0';
+        oddZeros += data[i + 1] == '\0';
+    }
+    const int probeUnits = probeSize / 2;
+    if (probeUnits >= 2) {
+        if (oddZeros * 4 > probeUnits && evenZeros * 8 < oddZeros) {
+            return Encoding::UTF16LE;
+        }
+        if (evenZeros * 4 > probeUnits && oddZeros * 8 < evenZeros) {
+            return Encoding::UTF16BE;
+        }
+    }
+    
     // 尝试验证是否为有效的UTF-8
     bool isValidUtf8 = true;
     int i = 0;
     while (i < data.size()) {
         uchar byte = static_cast<uchar>(data[i]);
         
-        // 单字节字符 (0xxxxxxx)
+        // 单字节字符 (0xxxxxxx)，整段64字节都是ASCII时一次跳过
         if ((byte & 0x80) == 0) {
-            i++;
+            if (i + 64 <= data.size() && TextDecoder::isAscii(data.constData() + i, 64)) {
+                i += 64;
+            } else {
+                i++;
+            }
             continue;
         }
         
@@ -74,7 +194,10 @@ Encoding CsvReader::detectEncoding(const QByteArray& data) const
         
         // 检查后续字节是否符合 10xxxxxx 格式
         for (int j = 1; j <= followingBytes; j++) {
-            if (i + j >= data.size() || (static_cast<uchar>(data[i + j]) & 0xC0) != 0x80) {
+            if (i + j >= data.size()) {
+                break; // 样本末尾被截断的字符不算错误
+            }
+            if ((static_cast<uchar>(data[i + j]) & 0xC0) != 0x80) {
                 isValidUtf8 = false;
                 break;
             }
@@ -94,149 +217,432 @@ Encoding CsvReader::detectEncoding(const QByteArray& data) const
     }
 }
 
-QString CsvReader::decodeData(const QByteArray& data) const
+Encoding CsvReader::detectFileEncoding(QFile &file, const QByteArray &head)
 {
-    // 处理UTF-8 BOM
-    QByteArray rawData = data;
-    if (rawData.size() >= 3 && rawData.startsWith(QByteArray("\xEF\xBB\xBF", 3))) {
-        rawData = rawData.mid(3); // 移除BOM
+    if (m_encoding != Encoding::AutoDetect) {
+        return m_encoding;
     }
     
-    // 如果是自动检测模式，先检测编码
-    Encoding encoding = m_encoding;
-    if (encoding == Encoding::AutoDetect) {
-        encoding = detectEncoding(rawData);
+    // 先检测文件开头，开头已能判定为非UTF-8时无需继续抽样
+    Encoding encoding = detectEncoding(head);
+    const qint64 fileSize = file.size();
+    if (encoding != Encoding::UTF8 || head.startsWith(QByteArray("\xEF\xBB\xBF", 3)) || fileSize <= head.size()) {
+        return encoding;
     }
     
-    switch (encoding) {
-    case Encoding::UTF8:
-        return QString::fromUtf8(rawData);
-    case Encoding::GBK:
-        return QString::fromLocal8Bit(rawData);
-    case Encoding::ASCII:
-        return QString::fromLatin1(rawData);
-    default:
-        return QString::fromUtf8(rawData);
+    // 开头可能全是ASCII表头和数字，再在文件其余部分均匀抽样，任何一块不是有效UTF-8都按GBK处理
+    const qint64 remainingBytes = fileSize - head.size();
+    for (int i = 1; i <= EncodingSampleCount; ++i) {
+        const qint64 offset = head.size() + remainingBytes * i / (EncodingSampleCount + 1);
+        if (!file.seek(offset)) {
+            break;
+        }
+        const QByteArray sample = file.read(EstimateSampleSize);
+        // 抽样起点可能落在多字节字符中间，跳过开头的后续字节(10xxxxxx)
+        int start = 0;
+        while (start < sample.size() && start < 3 && (static_cast<uchar>(sample[start]) & 0xC0) == 0x80) {
+            start++;
+        }
+        if (detectEncoding(QByteArray::fromRawData(sample.constData() + start, sample.size() - start)) != Encoding::UTF8) {
+            return Encoding::GBK;
+        }
     }
+    return Encoding::UTF8;
 }
 
-CsvInitializationData CsvReader::getInitializeData(const QString &fileName)
+bool CsvReader::readFileHead(QFile &file, CsvInitializationData &data, qint64 *scanOffset, bool *inQuotes)
 {
-    CsvInitializationData data;
-    data.totalRows = 0;
-    
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly)) { // 移除Text标志以正确处理位置
-        qDebug() << "Cannot open file:" << fileName;
-        return data;
+    // 只读取文件开头一小块：解析表头并为首屏建立索引，打开任意大小的文件都能立刻显示
+    const qint64 fileSize = file.size();
+    const QByteArray head = file.read(qMin(fileSize, HeadBlockSize));
+    *scanOffset = head.size();
+    *inQuotes = false;
+    if (head.isEmpty()) {
+        return false;
     }
     
-    // 读取文件开头部分用于编码检测
-    QByteArray sampleData = file.read(qMin(file.size(), static_cast<qint64>(1024 * 1024))); // 读取前1MB或整个文件
-    Encoding detectedEncoding = (m_encoding == Encoding::AutoDetect) ? detectEncoding(sampleData) : m_encoding;
+    m_headSignature = head.left(HeadSignatureSize);
     
-    // 重新打开文件以确保从头开始读取
-    file.close();
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << "Cannot reopen file:" << fileName;
-        return data;
+    // 编码每个文件只确定一次，之后所有字段都用同一个解码器
+    data.encoding = detectFileEncoding(file, head);
+    m_decoder.setEncoding(data.encoding);
+    
+    QVector<qint64> rowStarts;
+    RowIndexer::findRecordStarts(head.constData(), head.size(), 0, *inQuotes, rowStarts, m_decoder.codeUnit());
+    
+    // 读取表头（第一条记录，表头字段中可能包含带引号的换行）
+    const int headerLength = rowStarts.isEmpty() ? head.size() : static_cast<int>(rowStarts.first());
+    // 默认分隔符为逗号
+    data.delimiter = ",";
+    data.headers = parseRecord(head.constData(), headerLength, ',');
+    
+    QWriteLocker locker(&m_indexLock);
+    data.rowIndex.append(0); // 记录表头行位置
+    for (qint64 pos : rowStarts) {
+        // 最后一个换行符之后若没有数据，不算作新的一行
+        if (pos < fileSize) {
+            data.rowIndex.append(pos); // 记录第n行位置
+        }
     }
+    data.totalRows = data.rowIndex.rowCount();
+    return true;
+}
+
+bool CsvReader::scanRows(QFile &file, qint64 startOffset, qint64 endOffset, bool *inQuotes, CsvInitializationData &data, bool background)
+{
+    const qint64 fileSize = endOffset;
+    // 文件按波次映射，每个波次切分为多个块交给线程池并行扫描。
+    // 按波次映射可以限制32位进程的地址空间占用，也限制了未合并结果的内存。
+    const int threadCount = qMax(1, m_indexPool.maxThreadCount());
+    const qint64 chunkSize = 8LL * 1024 * 1024;
+    const qint64 waveSize = chunkSize * threadCount;
+    QVector<ChunkScanResult> chunkResults(threadCount);
+    const CodeUnit unit = TextDecoder::codeUnitOf(data.encoding); // 块大小为偶数，UTF-16的块起点保持码元对齐
+    QElapsedTimer progressTimer;
+    progressTimer.start();
     
-    // 读取表头
-    if (!file.atEnd()) {
-        qint64 pos = file.pos(); // 记录表头位置
-        QByteArray headerLine = file.readLine(); // 使用readLine而不是QTextStream
-        // 解码并分割表头
-        QString decodedHeader = decodeData(headerLine).trimmed();
-        data.headers = parseCsvLine(decodedHeader, ",");
-        data.rowPositions[0] = pos; // 记录表头行位置
-    }
-    
-#ifdef DEBUG_PRINT
-    // 计算总行数并记录每行位置
-    int testRowCount = 0; // 用于限制打印的测试行数
-    while (!file.atEnd() && testRowCount < 3) { // 只处理前三行数据用于测试
-        qint64 pos = file.pos(); // 记录每行起始位置
-        QByteArray dataLine = file.readLine();
-        data.rowPositions[data.totalRows + 1] = pos; // 记录第n行位置
-        data.totalRows++;
-        testRowCount++;
+    for (qint64 waveOffset = startOffset; waveOffset < fileSize; waveOffset += waveSize) {
+        if (background) {
+            // 可视窗口和预加载的读取排队或执行时暂停，避免与它们争用磁盘
+            m_scheduler.yieldToForeground(m_cancelIndexing);
+        }
+        if (m_cancelIndexing.loadRelaxed()) {
+            return false;
+        }
         
-        // 打印前三行数据及其位置用于测试
-        QString decodedLine = decodeData(dataLine).trimmed();
-        qDebug() << "数据行" << data.totalRows << "位置:" << pos << "内容:" << decodedLine;
+        const qint64 waveLength = qMin(waveSize, fileSize - waveOffset);
+        QByteArray fallbackBuffer;
+        const char *window = nullptr;
+        uchar *mapped = file.map(waveOffset, waveLength);
+        if (mapped) {
+            window = reinterpret_cast<const char *>(mapped);
+        } else {
+            // 映射失败时退回到按块读取
+            if (!file.seek(waveOffset)) {
+                qDebug() << "Failed to seek to position:" << waveOffset;
+                return false;
+            }
+            fallbackBuffer = file.read(waveLength);
+            window = fallbackBuffer.constData();
+        }
+        
+        // 每个块同时按"起点在引号外"和"起点在引号内"两种假设扫描
+        const int chunkCount = static_cast<int>((waveLength + chunkSize - 1) / chunkSize);
+        for (int c = 0; c < chunkCount; ++c) {
+            const qint64 chunkOffset = c * chunkSize;
+            const qint64 chunkLength = qMin(chunkSize, waveLength - chunkOffset);
+            ChunkScanResult *result = &chunkResults[c];
+            result->clear();
+            m_indexPool.start([window, chunkOffset, chunkLength, waveOffset, result, unit]() {
+                RowIndexer::scanChunk(window + chunkOffset, chunkLength, waveOffset + chunkOffset, *result, unit);
+            });
+        }
+        m_indexPool.waitForDone();
+        
+        if (mapped) {
+            file.unmap(mapped);
+        }
+        
+        // 前缀传递：按文件顺序确定每个块起点的引号状态，选出对应的一组行起始
+        {
+            QWriteLocker locker(&m_indexLock);
+            for (int c = 0; c < chunkCount; ++c) {
+                const ChunkScanResult &result = chunkResults[c];
+                const QVector<qint64> &rowStarts = *inQuotes ? result.rowStartsIfInside : result.rowStartsIfOutside;
+                for (qint64 pos : rowStarts) {
+                    // 最后一个换行符之后若没有数据，不算作新的一行
+                    if (pos < fileSize) {
+                        data.rowIndex.append(pos); // 记录第n行位置
+                    }
+                }
+                if (result.togglesQuoteState) {
+                    *inQuotes = !*inQuotes;
+                }
+            }
+            data.totalRows = data.rowIndex.rowCount();
+        }
+        
+        // 定期报告进度，让界面随索引增长扩展滚动范围
+        if (background && progressTimer.elapsed() >= ProgressIntervalMs) {
+            emit indexProgress(data.totalRows, false);
+            // 已索引部分是精确值，只有剩余部分按抽样密度估计，误差随扫描推进收敛到0
+            if (m_sampledRowsPerByte > 0.0) {
+                const qint64 remainingBytes = fileSize - (waveOffset + waveLength);
+                const qint64 estimatedRows = data.totalRows + qRound64(remainingBytes * m_sampledRowsPerByte);
+                const double error = m_estimateError * remainingBytes / qMax<qint64>(1, fileSize - startOffset);
+                emit rowCountEstimated(estimatedRows, error);
+            }
+            progressTimer.restart();
+        }
+    }
+    return true;
+}
+
+void CsvReader::estimateRowCount(QFile &file, qint64 indexedBytes, qint64 indexedRows)
+{
+    m_sampledRowsPerByte = 0.0;
+    m_estimateError = 1.0;
+    const qint64 remainingBytes = file.size() - indexedBytes;
+    if (indexedBytes <= 0 || remainingBytes < EstimateSampleCount * EstimateSampleSize) {
+        return; // 剩余部分很小，后台索引很快就能给出精确值
     }
-#endif
     
-    // 继续处理剩余行但不打印
-    while (!file.atEnd()) {
-        qint64 pos = file.pos(); // 记录每行起始位置
-        file.readLine();
-        data.rowPositions[data.totalRows + 1] = pos; // 记录第n行位置
-        data.totalRows++;
+    // 抽样块的起点不一定在引号外，无法区分记录边界和字段内换行。
+    // 用已精确索引的文件开头的"记录数/换行符数"比例修正抽样中的换行符密度
+    const CodeUnit unit = m_decoder.codeUnit();
+    QVector<qint64> newlines;
+    if (!file.seek(0)) {
+        return;
     }
+    const QByteArray head = file.read(indexedBytes);
+    RowIndexer::findRowStarts(head.constData(), head.size(), 0, newlines, unit);
+    const double recordsPerNewline = newlines.isEmpty() ? 1.0 : qMin(1.0, double(indexedRows) / newlines.size());
     
-    // 加上表头行
-    data.totalRows++;
+    // 在未索引部分均匀抽取若干块，统计每块的行密度
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    int samples = 0;
+    for (int i = 0; i < EstimateSampleCount; ++i) {
+        const qint64 offset = alignToCodeUnit(indexedBytes + (remainingBytes - EstimateSampleSize) * i / (EstimateSampleCount - 1), unit);
+        if (!file.seek(offset)) {
+            continue;
+        }
+        const QByteArray block = file.read(EstimateSampleSize);
+        if (block.isEmpty()) {
+            continue;
+        }
+        newlines.clear();
+        RowIndexer::findRowStarts(block.constData(), block.size(), 0, newlines, unit);
+        const double rowsPerByte = newlines.size() * recordsPerNewline / block.size();
+        sum += rowsPerByte;
+        sumSquares += rowsPerByte * rowsPerByte;
+        samples++;
+    }
+    if (samples < 2 || sum <= 0.0) {
+        return;
+    }
     
-    file.close();
+    // 以各块密度的标准误差给出95%置信区间的相对半宽
+    const double mean = sum / samples;
+    const double variance = qMax(0.0, (sumSquares - samples * mean * mean) / (samples - 1));
+    m_sampledRowsPerByte = mean;
+    m_estimateError = qMin(1.0, 1.96 * qSqrt(variance / samples) / mean);
     
-    // 默认分隔符为逗号
-    data.delimiter = ",";
+    emit rowCountEstimated(indexedRows + qRound64(remainingBytes * mean), m_estimateError);
+}
+
+void CsvReader::startBackgroundIndexing(qint64 scanOffset, bool inQuotes)
+{
+    m_cancelIndexing.storeRelaxed(0);
+    m_backgroundIndexing = true;
+    const QString fileName = m_FileName;
+    const quint64 generation = ++m_indexGeneration;
+    const Encoding requestedEncoding = m_encoding; // 在启动线程时取值，缓存键与本次索引使用的编码选择一致
+    m_indexThread = QThread::create([this, fileName, scanOffset, inQuotes, generation, requestedEncoding]() {
+        QFile file(fileName);
+        bool completed = false;
+        qint64 endOffset = 0;
+        bool tailInQuotes = inQuotes;
+        if (file.open(QIODevice::ReadOnly)) {
+            QElapsedTimer timer;
+            timer.start();
+            // 只索引到此刻的文件末尾，之后追加的内容由跟踪模式增量索引
+            endOffset = file.size();
+            completed = scanRows(file, scanOffset, endOffset, &tailInQuotes, m_initData, true);
+            if (completed) {
+                qCDebug(lcCsvReader) << "后台行索引建立完成:" << RowIndexer::implementationName() << "总行数:" << getTotalRows()
+                                     << "耗时(ms):" << timer.elapsed();
+                emit indexProgress(getTotalRows(), true);
+                // 写入磁盘缓存，下次打开同一文件时直接映射
+                QReadLocker locker(&m_indexLock);
+                IndexCache::save(fileName, requestedEncoding, m_initData, endOffset);
+            }
+        } else {
+            qCWarning(lcCsvReader) << "Cannot open file:" << fileName;
+        }
+        
+        // 回到工作线程记录索引终点，并检查索引期间文件是否又有追加
+        QMetaObject::invokeMethod(this, [this, generation, completed, endOffset, tailInQuotes]() {
+            if (generation != m_indexGeneration) {
+                return; // 已被取消，或已有新的索引任务
+            }
+            m_backgroundIndexing = false;
+            if (completed) {
+                m_indexedSize = alignToCodeUnit(endOffset, m_decoder.codeUnit());
+                m_tailInQuotes = tailInQuotes;
+                checkFileGrowth();
+            }
+        }, Qt::QueuedConnection);
+    });
+    m_indexThread->start();
+}
+
+void CsvReader::stopIndexing()
+{
+    if (!m_indexThread) {
+        return;
+    }
+    m_cancelIndexing.storeRelaxed(1);
+    m_indexThread->wait();
+    delete m_indexThread;
+    m_indexThread = nullptr;
+    m_cancelIndexing.storeRelaxed(0);
+    m_backgroundIndexing = false;
+    m_indexGeneration++; // 作废线程结束前投递的完成通知
+}
+
+void CsvReader::setFollowMode(bool enabled)
+{
+    m_followMode = enabled;
+    updateWatchedPaths();
+    if (enabled) {
+        // 开启时先补上关闭期间追加的内容
+        checkFileGrowth();
+    }
+}
+
+void CsvReader::setBlockCacheBudgets(qint64 hotBytes, qint64 coldBytes)
+{
+    m_blockCache.setBudget(hotBytes);
+    m_blockCache.setColdBudget(coldBytes);
+}
+
+void CsvReader::applyProjection(const QVector<int> &columns)
+{
+    QVector<int> sorted = columns;
+    std::sort(sorted.begin(), sorted.end());
+    if (sorted == m_projection) {
+        return;
+    }
+    m_projection = sorted;
+    m_blockCache.clear(); // 缓存的行块按旧的列集合切分
+}
+
+void CsvReader::updateWatchedPaths()
+{
+    const QStringList watched = m_watcher->files() + m_watcher->directories();
+    if (!watched.isEmpty()) {
+        m_watcher->removePaths(watched);
+    }
+    if (m_followMode && !m_FileName.isEmpty()) {
+        m_watcher->addPath(m_FileName);
+        m_watcher->addPath(QFileInfo(m_FileName).absolutePath());
+    }
+}
+
+void CsvReader::checkFileGrowth()
+{
+    if (!m_followMode || m_FileName.isEmpty()) {
+        return;
+    }
+    if (m_backgroundIndexing) {
+        return; // 后台索引完成后会再次检查
+    }
     
-    // 复制性能数据
-    data.performanceData = m_performanceData;
+    QFile file(m_FileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return; // 轮转过程中文件可能暂时不存在，等待下一次通知
+    }
+    // 文件被删除或替换后监视会自动移除，新文件出现时重新加入
+    if (!m_watcher->files().contains(m_FileName)) {
+        m_watcher->addPath(m_FileName);
+    }
     
-    return data;
+    // 文件变短或开头内容不同，说明被截断或已轮转为新文件，之前的索引全部作废
+    const CodeUnit unit = m_decoder.codeUnit();
+    const qint64 fileSize = alignToCodeUnit(file.size(), unit);
+    const bool truncated = fileSize < m_indexedSize;
+    const bool replaced = !truncated && file.read(m_headSignature.size()) != m_headSignature;
+    if (truncated || replaced) {
+        qDebug() << "文件被截断或替换，重新建立索引:" << m_FileName;
+        file.close();
+        init(m_FileName);
+        return;
+    }
+    if (fileSize == m_indexedSize) {
+        return;
+    }
+    
+    // 只扫描新追加的字节。上次索引终点若恰好是记录结尾，当时其后没有数据不算新行，现在补上
+    const qint64 previousRows = getTotalRows();
+    bool inQuotes = m_tailInQuotes;
+    const int unitSize = codeUnitSize(unit);
+    if (m_indexedSize > 0 && !inQuotes && file.seek(m_indexedSize - unitSize)) {
+        const QByteArray lastChar = file.read(unitSize);
+        if (lastChar.size() == unitSize && loadCodeUnit(lastChar.constData(), unit) == '\n') {
+            QWriteLocker locker(&m_indexLock);
+            m_initData.rowIndex.append(m_indexedSize);
+            m_initData.totalRows = m_initData.rowIndex.rowCount();
+        }
+    }
+    if (!scanRows(file, m_indexedSize, fileSize, &inQuotes, m_initData, false)) {
+        return;
+    }
+    m_indexedSize = fileSize;
+    m_tailInQuotes = inQuotes;
+    // 原来的最后一行可能是写了一半的记录，包含它的行块及之后的缓存都要重新读取
+    if (previousRows > 0) {
+        m_blockCache.removeFrom((previousRows - 1) / RowBlockCache::BlockRows);
+    }
+    
+    emit fileAppended(getTotalRows());
 }
 
-CsvRowData CsvReader::getRowsData(const QString &fileName, qint64 startRow, qint64 rowCount)
+CsvRowData CsvReader::getRowsData(const QString &fileName, qint64 startRow, qint64 rowCount, quint64 generation,
+                                  ReadPriority priority)
 {
     CsvRowData data;
     
-    // 检查是否需要重新初始化（文件是否改变）
-    if (isFileChanged(fileName) || m_initData.rowPositions.isEmpty()) {
-        m_initData = getInitializeData(fileName);
+    // 文件改变时重新初始化：与打开文件相同，只同步索引文件开头，其余交给后台线程，不阻塞读取线程
+    // 总行数为0不再触发重建：init已同步索引开头，此时文件没有数据行，增长由跟踪模式处理
+    if (isFileChanged(fileName)) {
+        init(fileName);
     }
     
-    QFile file(fileName);
-    if (!file.open(QIODevice::ReadOnly)) { // 移除Text标志以正确处理位置
-        qDebug() << "Cannot open file:" << fileName;
+    // 文件句柄在打开文件时建立，之后的每次请求不再打开和关闭文件
+    if (m_file.fileName() != fileName && !m_file.open(fileName)) {
         return data;
     }
     
     // 检查起始行是否有效
-    if (startRow >= m_initData.totalRows || startRow < 0) {
+    if (startRow >= getTotalRows() || startRow < 0) {
         qDebug() << "Invalid start row:" << startRow;
-        file.close();
         return data;
     }
     
-    // 定位到起始行
-    if (m_initData.rowPositions.contains(startRow)) {
-        if (!file.seek(m_initData.rowPositions[startRow])) {
-            qDebug() << "Failed to seek to position:" << m_initData.rowPositions[startRow];
-            file.close();
-            return data;
+    // 按固定的行块读取，先查缓存，未命中时读取并切分整块；结果只引用各块中请求的行，不复制
+    const qint64 endRow = startRow + rowCount;
+    for (qint64 blockNumber = startRow / RowBlockCache::BlockRows;
+         blockNumber * RowBlockCache::BlockRows < endRow; ++blockNumber) {
+        if (shouldStopRead(generation, priority)) {
+            return data; // 已作废或被抢占，不完整的结果由调用方丢弃或重新排队
+        }
+        const qint64 blockStart = blockNumber * RowBlockCache::BlockRows;
+        QSharedPointer<const RowBlock> block = m_blockCache.find(blockNumber);
+        if (!block) {
+            block = readRowBlock(blockStart, RowBlockCache::BlockRows, generation, priority);
+            if (m_readInterrupted) {
+                return data; // 中途停止的块行数不全，既不缓存也不切分
+            }
+            // 到达文件末尾的不完整块不缓存，跟踪模式下它还会增长
+            if (block->rowCount() == RowBlockCache::BlockRows) {
+                m_blockCache.insert(blockNumber, block);
+            }
+        }
+        const int first = static_cast<int>(qMax(startRow, blockStart) - blockStart);
+        const int count = static_cast<int>(qMin<qint64>(endRow - blockStart, block->rowCount())) - first;
+        if (count <= 0) {
+            break; // 文件在索引之后被截断，块内已没有请求的行
+        }
+        data.rows.append(block, first, count);
+        if (block->rowCount() < RowBlockCache::BlockRows) {
+            break;
         }
-    } else {
-        qDebug() << "Row position not found for row:" << startRow;
-        file.close();
-        return data;
-    }
-    
-    // 读取指定数量的行
-    qint64 rowsRead = 0;
-    while (rowsRead < rowCount && !file.atEnd()) {
-        QByteArray line = file.readLine();
-        QString lineStr = decodeData(line).trimmed();
-        // 使用更健壮的CSV解析方法
-        QStringList rowData = parseCsvLine(lineStr, m_initData.delimiter);
-        data.rows.append(rowData);
-        rowsRead++;
     }
-    
-    file.close();
+    // 缓存命中和占用随结果显示在状态栏，压缩实现和行块池的复用情况只在调试时输出
+    qCDebug(lcCsvReader) << "冷层压缩:" << BlockCompressor::implementationName()
+                         << "行块池: 新分配" << RowBlockPool::instance().allocations()
+                         << "复用" << RowBlockPool::instance().reuses();
     
     // 复制性能数据
     data.performanceData = m_performanceData;
@@ -244,63 +650,211 @@ CsvRowData CsvReader::getRowsData(const QString &fileName, qint64 startRow, qint
     return data;
 }
 
-// 新增方法：解析单行CSV数据
-QStringList CsvReader::parseCsvLine(const QString &line, const QString &delimiter)
+QSharedPointer<const RowBlock> CsvReader::readRowBlock(qint64 startRow, qint64 rowCount, quint64 generation,
+                                                      ReadPriority priority)
 {
-    QStringList result;
-    bool inQuotes = false;
-    QString currentField;
-    int delimiterLength = delimiter.length();
+    // 复用池中的块，缓冲区的容量在读取同样大小的块时通常已经足够
+    const QSharedPointer<RowBlock> block = RowBlockPool::instance().acquire();
+    RowBlock &rows = *block;
+    rows.setEncoding(m_decoder.encoding());
+    rows.setColumns(m_projection);
     
-    for (int i = 0; i < line.length(); ++i) {
-        QChar ch = line[i];
-        
-        // 处理双引号转义
-        if (ch == '"') {
-            if (i + 1 < line.length() && line[i + 1] == '"') {
-                // 双引号表示一个引号字符
-                currentField += '"';
-                i++; // 跳过下一个引号
-            } else {
-                // 切换引号状态
-                inQuotes = !inQuotes;
+    // 行块超出已索引的范围时返回空块
+    if (startRow >= getTotalRows()) {
+        return block;
+    }
+    const qint64 rowOffset = findRowOffset(startRow);
+    if (rowOffset < 0) {
+        qDebug() << "Row position not found for row:" << startRow;
+        return block;
+    }
+    
+    // 按记录边界读取指定数量的行：带引号的字段可以包含换行，一条记录可能跨越多个物理行
+    qint64 readOffset = rowOffset;
+    const char delimiter = m_initData.delimiter.isEmpty() ? ',' : m_initData.delimiter.at(0).toLatin1();
+    QByteArray record; // 跨块记录的前半部分
+    bool inQuotes = false;
+    QVector<qint64> recordEnds;
+    // 只切分不解码，原始字节随块交给界面，单元格显示时才解码
+    while (rows.rowCount() < rowCount && !shouldStopRead(generation, priority)) {
+        qint64 blockSize = 0;
+        const char *block = readBlock(readOffset, &blockSize);
+        if (!block || blockSize == 0) {
+            // 文件末尾的最后一条记录可能没有换行符
+            if (!record.isEmpty()) {
+                rows.appendRecord(record.constData(), record.size(), delimiter, m_fieldSpans);
             }
-            continue;
+            break;
         }
         
-        // 检查分隔符
-        if (!inQuotes && i + delimiterLength <= line.length()) {
-            QString substr = line.mid(i, delimiterLength);
-            if (substr == delimiter) {
-                result.append(currentField);
-                currentField.clear();
-                i += delimiterLength - 1; // 跳过分隔符（循环会自动+1）
-                continue;
+        recordEnds.clear();
+        RowIndexer::findRecordStarts(block, blockSize, 0, inQuotes, recordEnds, m_decoder.codeUnit());
+        readOffset += blockSize;
+        qint64 recordStart = 0;
+        for (qint64 recordEnd : recordEnds) {
+            if (rows.rowCount() >= rowCount) {
+                break;
             }
+            const char *recordData = block + recordStart;
+            const int recordLength = static_cast<int>(recordEnd - recordStart);
+            if (record.isEmpty()) {
+                // 记录完整位于块内，直接在块上切分，不复制
+                rows.appendRecord(recordData, recordLength, delimiter, m_fieldSpans);
+            } else {
+                record.append(recordData, recordLength);
+                rows.appendRecord(record.constData(), record.size(), delimiter, m_fieldSpans);
+                record.clear();
+            }
+            recordStart = recordEnd;
+        }
+        if (rows.rowCount() < rowCount) {
+            record.append(block + recordStart, static_cast<int>(blockSize - recordStart));
         }
-        
-        currentField += ch;
     }
     
-    // 添加最后一个字段
-    result.append(currentField);
+    return block;
+}
+
+const char *CsvReader::readBlock(qint64 offset, qint64 *size)
+{
+    // 缓冲区只在首次使用时分配，之后每次读取都是一次按偏移读取的系统调用
+    if (m_readBuffer.size() != ReadBlockSize) {
+        m_readBuffer.resize(ReadBlockSize);
+    }
+    *size = m_file.read(offset, m_readBuffer.data(), ReadBlockSize);
+    if (*size < 0) {
+        qDebug() << "Failed to read at position:" << offset;
+        return nullptr;
+    }
+    return m_readBuffer.constData();
+}
+
+qint64 CsvReader::findRowOffset(qint64 row)
+{
+    qint64 checkpointOffset = 0;
+    qint64 rowsToSkip = 0;
+    {
+        // 后台索引线程可能正在追加行，只在查找检查点时加读锁
+        QReadLocker locker(&m_indexLock);
+        if (!m_initData.rowIndex.locate(row, &checkpointOffset, &rowsToSkip)) {
+            return -1;
+        }
+    }
     
+    // 检查点总在记录起始处，从检查点开始按引号状态向后扫描剩余行
+    qint64 blockOffset = checkpointOffset;
+    bool inQuotes = false;
+    QVector<qint64> rowStarts;
+    while (rowsToSkip > 0) {
+        qint64 blockSize = 0;
+        const char *block = readBlock(blockOffset, &blockSize);
+        if (!block || blockSize == 0) {
+            return -1;
+        }
+        rowStarts.clear();
+        RowIndexer::findRecordStarts(block, blockSize, blockOffset, inQuotes, rowStarts, m_decoder.codeUnit());
+        if (rowStarts.size() >= rowsToSkip) {
+            return rowStarts.at(rowsToSkip - 1);
+        }
+        rowsToSkip -= rowStarts.size();
+        blockOffset += blockSize;
+    }
+    return checkpointOffset;
+}
+
+QStringList CsvReader::parseRecord(const char *data, int size, char delimiter)
+{
+    // 先在原始字节上切分出字段位置，再逐个字段解码；切分阶段复用m_fieldSpans，不按字段分配内存
+    const CodeUnit unit = m_decoder.codeUnit();
+    CsvTokenizer::trim(data, size, unit);
+    CsvTokenizer::tokenize(data, size, delimiter, m_fieldSpans, unit);
+    
+    QStringList result;
+    result.reserve(m_fieldSpans.size());
+    for (const FieldSpan &field : m_fieldSpans) {
+        if (field.needsUnescape) {
+            const QByteArray unescaped = CsvTokenizer::unescape(data, field, unit);
+            result.append(m_decoder.decode(unescaped.constData(), unescaped.size()));
+        } else {
+            result.append(m_decoder.decode(data + field.offset, field.length));
+        }
+    }
     return result;
 }
 
 void CsvReader::init(const QString &fileName)
 {
+    // 打开新文件前先停止上一个文件的后台索引
+    stopIndexing();
+    m_scheduler.clear(); // 排队中的请求属于上一个文件
     m_FileName = fileName;
-    // 获取初始化数据
-    m_initData = getInitializeData(fileName);
-    // 发送表头数据给主窗口
-    emit initializationDataReady(m_initData.headers);
+    m_file.open(fileName); // 整个查看期间保持打开；文件被截断或替换时会重新调用init，重新打开新文件
+    m_projection.clear(); // 新文件的列不同，重新读取全部列
+    m_blockCache.clear();
+    m_indexedSize = 0;
+    m_tailInQuotes = false;
+    m_headSignature.clear();
+    updateWatchedPaths();
+    
+    CsvInitializationData data;
+    data.totalRows = 0;
+    
+    // 文件未变化时直接映射上次建立的索引，无需重新扫描
+    if (IndexCache::load(fileName, m_encoding, data)) {
+        data.rowIndex.setMemoryBudget(m_indexMemoryBudget);
+        m_decoder.setEncoding(data.encoding);
+        // 缓存只针对完整的文件建立，按常规文件结尾在引号外处理
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            m_headSignature = file.read(HeadSignatureSize);
+            m_indexedSize = alignToCodeUnit(file.size(), m_decoder.codeUnit());
+        }
+        {
+            QWriteLocker locker(&m_indexLock);
+            m_initData = data;
+        }
+        emit initializationDataReady(data.headers);
+        emit indexProgress(data.totalRows, true);
+        return;
+    }
+    data.rowIndex.setMemoryBudget(m_indexMemoryBudget);
+    
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "Cannot open file:" << fileName;
+    }
+    
+    // 先只索引文件开头，剩余部分交给后台线程
+    qint64 scanOffset = 0;
+    bool inQuotes = false;
+    if (file.isOpen()) {
+        readFileHead(file, data, &scanOffset, &inQuotes);
+    }
+    const bool finished = !file.isOpen() || scanOffset >= file.size();
+    
+    {
+        QWriteLocker locker(&m_indexLock);
+        m_initData = data;
+    }
+    
+    // 发送表头数据给主窗口，首屏数据此时已经可以读取
+    emit initializationDataReady(data.headers);
+    emit indexProgress(data.totalRows, finished);
+    
+    if (!finished) {
+        // 先给出抽样估计的总行数，滚动条立即可用，随后由后台索引逐步修正
+        estimateRowCount(file, scanOffset, data.totalRows);
+        startBackgroundIndexing(scanOffset, inQuotes);
+    } else {
+        m_indexedSize = scanOffset;
+        m_tailInQuotes = inQuotes;
+    }
+    file.close();
 }
 
 bool CsvReader::isFileChanged(const QString &fileName)
 {
-    // 简单实现：检查文件名是否改变
-    // TODO: 更复杂的实现可以检查文件修改时间或校验和
+    // 只检查文件名是否改变：同一文件的追加、截断和替换由跟踪模式处理（见checkFileGrowth）
     return m_FileName != fileName;
 }
 
@@ -311,20 +865,85 @@ void CsvReader::processFile(const QString &fileName)
     Q_UNUSED(fileName)
 }
 
-void CsvReader::readRows(qint64 startRow, qint64 rowCount)
+void CsvReader::executeRead(const ReadRequest &request)
 {
     if (m_FileName.isEmpty()) {
         qDebug() << "No file opened";
         return;
     }
+    // 快速拖动时队列中积压的请求在执行前就已作废，直接丢弃
+    if (isStale(request.generation)) {
+        qCDebug(lcCsvReader) << "丢弃过期的读取请求: startRow=" << request.startRow << ", 代数=" << request.generation;
+        return;
+    }
+    
+    // 列投影随请求一起提交，执行时才切换，先于投影变化排队的请求不会用新的列集合读取，反之亦然
+    applyProjection(request.projection);
     
     // 获取数据行
-    CsvRowData rowData = getRowsData(m_FileName, startRow, rowCount);
-    // 发送数据给主窗口
-    emit rowDataReady(rowData, startRow);
+    m_readInterrupted = false;
+    m_scheduler.beginRequest(request.priority);
+    CsvRowData rowData = getRowsData(m_FileName, request.startRow, request.rowCount, request.generation, request.priority);
+    m_scheduler.endRequest(request.priority);
+    if (m_readInterrupted) {
+        // 拖动滚动条时每帧都有请求作废或被抢占，日志默认关闭
+        if (isStale(request.generation)) {
+            qCDebug(lcCsvReader) << "读取中途作废: startRow=" << request.startRow << ", 代数=" << request.generation;
+        } else {
+            // 被更高优先级的请求抢占：已读完的完整行块留在缓存中，重新执行时直接命中
+            qCDebug(lcCsvReader) << "读取被抢占，重新排队: startRow=" << request.startRow
+                                 << ", 优先级=" << ReadScheduler::priorityName(request.priority);
+            m_scheduler.requeue(request);
+            QMetaObject::invokeMethod(this, &CsvReader::processReadQueue, Qt::QueuedConnection);
+        }
+        return;
+    }
+    
+    for (int i = 0; i < ReadScheduler::PriorityCount; ++i) {
+        rowData.queueStats.append(m_scheduler.stats(static_cast<ReadPriority>(i)));
+    }
+    rowData.cacheStats = m_blockCache.stats();
+    // 放入结果通道。通道满时（界面线程暂时没有取走）阻塞到界面线程取走结果，请求作废或线程退出时放弃
+    ReadResult result;
+    result.rowData = rowData;
+    result.startRow = request.startRow;
+    result.generation = request.generation;
+    if (!m_results.push(result)) {
+        QMutexLocker locker(&m_resultsMutex);
+        while (!m_results.push(result)) {
+            if (isStale(request.generation) || QThread::currentThread()->isInterruptionRequested()) {
+                qCDebug(lcCsvReader) << "读取结果通道已满，丢弃结果: startRow=" << request.startRow;
+                return;
+            }
+            m_resultsSpace.wait(&m_resultsMutex);
+        }
+    }
+    // 只在界面线程取走之前的第一个结果时通知，同一帧内到达的结果一起处理
+    if (m_resultsPending.testAndSetOrdered(0, 1)) {
+        emit rowDataAvailable();
+    }
+}
+
+int CsvReader::takeRowData(QVector<ReadResult> *results)
+{
+    // 先清除标志再取：之后放入的结果会重新通知，不会遗漏
+    m_resultsPending.fetchAndStoreOrdered(0);
+    int count = 0;
+    ReadResult result;
+    while (m_results.pop(&result)) {
+        results->append(result);
+        count++;
+    }
+    if (count > 0) {
+        // 加锁后唤醒：工作线程在检查通道和开始等待之间持有锁，不会错过这次唤醒
+        QMutexLocker locker(&m_resultsMutex);
+        m_resultsSpace.wakeAll();
+    }
+    return count;
 }
 
 qint64 CsvReader::getTotalRows() const
 {
+    QReadLocker locker(&m_indexLock);
     return m_initData.totalRows;
 }
@@ -6,13 +6,34 @@
 #include <QVector>
 #include <QMap>
 #include <QElapsedTimer>
+#include <QThreadPool>
+#include <QFile>
+#include <QThread>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include "rowindex.h"
+#include "csvtokenizer.h"
+#include "textdecoder.h"
+#include "rowblock.h"
+#include "rowwindow.h"
+#include "positionalfile.h"
+#include "rowblockcache.h"
+#include "readscheduler.h"
+#include "spscqueue.h"
 
 // 添加编码枚举
 enum class Encoding {
     UTF8,
     GBK,
     ASCII,
-    AutoDetect
+    AutoDetect,
+    UTF16LE, // 新增的值追加在末尾，索引缓存中保存的旧值含义不变
+    UTF16BE
 };
 // Q_ENUM(Encoding) 移至 CsvReader 类内部
 
@@ -20,14 +41,24 @@ struct CsvInitializationData {
     QVector<QString> headers;
     qint64 totalRows;
     QString delimiter;
-    QMap<qint64, qint64> rowPositions; // 行号到文件位置的映射
+    RowIndex rowIndex; // 行号到文件位置的紧凑索引
+    Encoding encoding = Encoding::AutoDetect; // 打开文件时检测到的编码
     QMap<QString, qint64> performanceData; // 性能数据
 };
 
 // 添加一个新的结构体来存储读取的数据
 struct CsvRowData {
-    QVector<QStringList> rows;  // 数据行
+    RowWindow rows; // 数据行，引用缓存中的只读行块（原始字节和字段位置，显示时才解码），传递时不复制
     QMap<QString, qint64> performanceData; // 性能数据
+    QVector<ReadQueueStats> queueStats; // 各优先级的读取队列统计，按ReadPriority的顺序
+    BlockCacheStats cacheStats; // 读取完成时的行块缓存统计
+};
+
+// 一个读取请求的结果，经由读取结果通道交给界面线程
+struct ReadResult {
+    CsvRowData rowData;
+    qint64 startRow = 0;
+    quint64 generation = 0; // 所属请求的代数，界面线程丢弃不是最新一代的结果
 };
 
 class CsvReader : public QObject
@@ -35,14 +66,20 @@ class CsvReader : public QObject
     Q_OBJECT
 public:
     explicit CsvReader(QObject *parent = nullptr);
+    ~CsvReader();
     Q_ENUM(Encoding)
     
-    CsvInitializationData getInitializeData(const QString &fileName);
-    CsvRowData getRowsData(const QString &fileName, qint64 startRow, qint64 rowCount); // 添加读取数据行的方法
+    CsvRowData getRowsData(const QString &fileName, qint64 startRow, qint64 rowCount, quint64 generation = 0,
+                           ReadPriority priority = ReadPriority::Visible); // 添加读取数据行的方法，请求作废或被抢占时中途返回
     const QMap<QString, qint64>& getPerformanceData() const; // 添加获取性能数据的公共方法
-    void setEncoding(Encoding encoding); // 设置编码
+    void setEncoding(Encoding encoding); // 设置编码（下次打开文件时生效）
     Encoding getEncoding() const; // 获取当前编码
-    qint64 getTotalRows() const; // 获取总行数
+    qint64 getTotalRows() const; // 获取总行数（已索引的行数，线程安全）
+    void setIndexMemoryBudget(qint64 bytes); // 设置行索引内存预算（下次建立索引时生效，0为不限制）
+    void cancelRequestsBefore(quint64 generation); // 线程安全：代数小于generation的读取请求作废，排队中的不再执行，执行中的在下一次读取前中止，等待通道空位的放弃结果
+    void submitRead(qint64 startRow, qint64 rowCount, quint64 generation, ReadPriority priority,
+                    const QVector<int> &projection); // 线程安全：提交读取请求，工作线程按优先级执行，结果放入读取结果通道；projection为读取的列（升序的原始列号），为空时读取全部列
+    int takeRowData(QVector<ReadResult> *results); // 只由界面线程调用：清除通知标志后取出通道中的全部结果，返回取出的个数
 
 private:
     QString m_FileName;
@@ -50,21 +87,77 @@ private:
     QElapsedTimer m_timer; // 计时器
     QMap<QString, qint64> m_performanceData; // 性能数据
     Encoding m_encoding; // 当前编码
+    qint64 m_indexMemoryBudget; // 行索引内存预算
+    QThreadPool m_indexPool; // 并行建立行索引的线程池
+    QThread *m_indexThread; // 后台建立行索引的线程
+    QAtomicInt m_cancelIndexing; // 置1时后台索引在下一个波次前退出
+    bool m_backgroundIndexing; // 后台索引是否尚未完成（只在工作线程读写）
+    quint64 m_indexGeneration; // 每次启动或停止后台索引时递增，用于丢弃过期的完成通知
+    mutable QReadWriteLock m_indexLock; // 保护m_initData中的行索引和总行数
+    static constexpr qint64 HeadBlockSize = 256 * 1024; // 打开文件时同步索引的开头字节数
+    static constexpr qint64 ProgressIntervalMs = 100; // 后台索引进度报告间隔
+    static constexpr int EstimateSampleCount = 16; // 估计总行数时均匀抽样的块数
+    static constexpr qint64 EstimateSampleSize = 64 * 1024; // 每个抽样块的字节数
+    double m_sampledRowsPerByte; // 抽样得到的每字节行数，后台索引时用来修正剩余部分的估计
+    double m_estimateError; // 抽样估计的相对误差
+    QFileSystemWatcher *m_watcher; // 跟踪模式下监视文件及其所在目录
+    QTimer *m_followTimer; // 合并短时间内的多次变化通知
+    bool m_followMode; // 是否跟踪文件追加
+    qint64 m_indexedSize; // 索引已覆盖的文件字节数
+    bool m_tailInQuotes; // 索引终点处的引号状态
+    QByteArray m_headSignature; // 打开时文件开头的内容，用来识别文件被替换（日志轮转）
+    static constexpr int FollowDebounceMs = 200;
+    static constexpr int HeadSignatureSize = 4096;
+    QVector<FieldSpan> m_fieldSpans; // 切分记录时复用的字段位置缓冲区
+    QVector<int> m_projection; // 读取数据行时只保存的原始列号（升序），为空时保存全部列；由执行中的请求设置
+    PositionalFile m_file; // 读取数据行的文件句柄，打开文件时打开，之后每次请求只做按偏移读取
+    QByteArray m_readBuffer; // 读取数据行复用的缓冲区
+    static constexpr qint64 ReadBlockSize = 64 * 1024; // 读取数据行时每次读取的字节数
+    RowBlockCache m_blockCache; // 最近读取的行块，可视窗口和预加载请求都先在这里查找；只在工作线程中访问
+    TextDecoder m_decoder; // 按当前文件编码解码字段，打开文件时设置一次
+    static constexpr int EncodingSampleCount = 8; // 检测编码时在文件开头之外抽样的块数
     Encoding detectEncoding(const QByteArray& data) const; // 检测编码
-    QString decodeData(const QByteArray& data) const; // 解码数据
+    Encoding detectFileEncoding(QFile &file, const QByteArray &head); // 由文件开头和均匀抽样的若干块确定整个文件的编码
     void startTiming(const QString &operation);
     void endTiming(const QString &operation);
     bool isFileChanged(const QString &fileName); // 检查文件是否发生变化
-    QStringList parseCsvLine(const QString &line, const QString &delimiter); // 添加CSV行解析函数
+    bool readFileHead(QFile &file, CsvInitializationData &data, qint64 *scanOffset, bool *inQuotes); // 解析表头并索引文件开头
+    bool scanRows(QFile &file, qint64 startOffset, qint64 endOffset, bool *inQuotes, CsvInitializationData &data, bool background); // 并行索引[startOffset, endOffset)，inQuotes返回结尾的引号状态，被取消时返回false；background为true时报告进度并在每个波次前让出给前台读取
+    void estimateRowCount(QFile &file, qint64 indexedBytes, qint64 indexedRows); // 抽样估计总行数并发出rowCountEstimated
+    void startBackgroundIndexing(qint64 scanOffset, bool inQuotes); // 在后台线程继续建立索引
+    void stopIndexing(); // 取消并等待后台索引线程
+    void updateWatchedPaths(); // 按跟踪模式和当前文件更新监视列表
+    void checkFileGrowth(); // 增量索引文件新追加的内容，检测到截断或替换时重新建立索引
+    qint64 findRowOffset(qint64 row); // 由行索引检查点定位指定行的文件偏移，失败返回-1
+    const char *readBlock(qint64 offset, qint64 *size); // 从offset读取一块到m_readBuffer，size返回实际字节数，出错返回nullptr
+    QSharedPointer<const RowBlock> readRowBlock(qint64 startRow, qint64 rowCount, quint64 generation, ReadPriority priority); // 从文件读取并切分连续若干行（块取自RowBlockPool），中途停止时返回不完整的块
+    QAtomicInteger<quint64> m_latestGeneration; // 界面线程最近一次发出的可视窗口请求代数，更早的请求已作废
+    bool isStale(quint64 generation) const; // 请求是否已作废（代数为0的请求从不作废）
+    ReadScheduler m_scheduler; // 读取请求的优先级队列
+    bool m_readInterrupted; // 当前读取因作废或被更高优先级抢占而中途停止
+    bool shouldStopRead(quint64 generation, ReadPriority priority); // 读取循环中检查是否应停止，停止时置位m_readInterrupted
+    void processReadQueue(); // 执行调度器中优先级最高的一个请求（每个入队的请求对应一次调用）
+    void executeRead(const ReadRequest &request); // 执行一个读取请求并把结果放入通道
+    void applyProjection(const QVector<int> &columns); // 执行请求前切换到请求的列投影，列集合变化时清空行块缓存
+    static constexpr int ResultChannelSize = 64; // 读取结果通道的容量，界面线程每帧取空
+    SpscQueue<ReadResult, ResultChannelSize> m_results; // 工作线程到界面线程的读取结果通道
+    QAtomicInt m_resultsPending; // 通道由空变为非空后置1，界面线程取结果前清0；置1时发出rowDataAvailable
+    QMutex m_resultsMutex; // 与m_resultsSpace配合，工作线程等待通道空位时不会错过唤醒
+    QWaitCondition m_resultsSpace; // 界面线程取走结果或请求作废时唤醒等待通道空位的工作线程
+    QStringList parseRecord(const char *data, int size, char delimiter); // 切分一条原始记录并解码各字段
 
 signals:
     void initializationDataReady(const QVector<QString> &headers);
-    void rowDataReady(const CsvRowData &rowData, qint64 startRow); // 添加数据行读取完成信号
+    void indexProgress(qint64 totalRows, bool finished); // 后台索引进度，totalRows为当前已索引行数
+    void rowCountEstimated(qint64 estimatedRows, double relativeError); // 索引完成前的总行数估计，relativeError为95%置信区间的相对半宽
+    void fileAppended(qint64 totalRows); // 跟踪模式下新追加的内容已建立索引
+    void rowDataAvailable(); // 读取结果通道中有新结果，界面线程取走之前不再重复发出
 
 public slots:
     void init(const QString &fileName);
     void processFile(const QString &fileName);
-    void readRows(qint64 startRow, qint64 rowCount); // 添加读取数据行的槽函数
+    void setFollowMode(bool enabled); // 开启后监视文件追加并增量扩展索引
+    void setBlockCacheBudgets(qint64 hotBytes, qint64 coldBytes); // 设置行块缓存两层的内存预算，缓存只在工作线程访问，须经排队连接调用
 
 };
 
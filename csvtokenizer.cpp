@@ -0,0 +1,315 @@
+#include "csvtokenizer.h"
+#include "cpufeatures.h"
+#include "quotemask.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+namespace {
+
+inline bool isAsciiSpace(quint16 ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' || ch == '\v' || ch == '\f';
+}
+
+// 记录[start, end)范围的字段。没有引号或整个字段恰好被一对引号包围时直接给出内容范围，
+// 其余含引号的情况交给unescape按引号规则处理
+inline void appendField(const char *data, int start, int end, int quoteCount, QVector<FieldSpan> &fields,
+                        CodeUnit unit = CodeUnit::Byte)
+{
+    const int width = codeUnitSize(unit);
+    FieldSpan field;
+    if (quoteCount == 0) {
+        field.offset = start;
+        field.length = end - start;
+    } else if (quoteCount == 2 && end - start >= 2 * width && loadCodeUnit(data + start, unit) == '"'
+               && loadCodeUnit(data + end - width, unit) == '"') {
+        field.offset = start + width;
+        field.length = end - start - 2 * width;
+    } else {
+        field.offset = start;
+        field.length = end - start;
+        field.needsUnescape = true;
+    }
+    fields.append(field);
+}
+
+using TokenizeFn = void (*)(const char *, int, char, QVector<FieldSpan> &);
+
+void tokenizeScalar(const char *data, int size, char delimiter, QVector<FieldSpan> &fields)
+{
+    int fieldStart = 0;
+    int quoteCount = 0;
+    bool inQuotes = false;
+    // 成对的""会切换两次引号状态，因此引号状态就是已遇到引号个数的奇偶性
+    for (int i = 0; i < size; ++i) {
+        const char ch = data[i];
+        if (ch == '"') {
+            inQuotes = !inQuotes;
+            quoteCount++;
+        } else if (ch == delimiter && !inQuotes) {
+            appendField(data, fieldStart, i, quoteCount, fields);
+            fieldStart = i + 1;
+            quoteCount = 0;
+        }
+    }
+    appendField(data, fieldStart, size, quoteCount, fields);
+}
+
+// UTF-16按对齐的码元切分，字段位置仍以字节为单位，不足一个码元的尾字节忽略
+template <CodeUnit Unit>
+void tokenizeWide(const char *data, int size, char delimiter, QVector<FieldSpan> &fields)
+{
+    const int end = size - size % 2;
+    const quint16 separator = static_cast<uchar>(delimiter);
+    int fieldStart = 0;
+    int quoteCount = 0;
+    bool inQuotes = false;
+    for (int i = 0; i < end; i += 2) {
+        const quint16 ch = loadCodeUnit(data + i, Unit);
+        if (ch == '"') {
+            inQuotes = !inQuotes;
+            quoteCount++;
+        } else if (ch == separator && !inQuotes) {
+            appendField(data, fieldStart, i, quoteCount, fields, Unit);
+            fieldStart = i + 2;
+            quoteCount = 0;
+        }
+    }
+    appendField(data, fieldStart, end, quoteCount, fields, Unit);
+}
+
+#if defined(CSV_SIMD_X86)
+
+// 跨64字节块保持的切分状态
+struct BlockState {
+    int fieldStart = 0;   // 当前字段的起始字节
+    int fieldQuotes = 0;  // 当前字段在之前各块中的引号个数
+    bool inQuotes = false;
+};
+
+// 按一个64字节块的结构字符掩码输出字段：引号外的分隔符就是字段边界，
+// 每个字段的引号个数由引号掩码的popcount得出，供appendField判断是否需要反转义
+inline void classifyBlock(const char *data, quint64 quoteMask, quint64 delimiterMask, quint64 insideMask,
+                          int blockOffset, BlockState &state, QVector<FieldSpan> &fields)
+{
+    quint64 boundaries = delimiterMask & ~insideMask;
+    int consumedQuotes = 0; // 本块中已归入之前字段的引号个数
+    while (boundaries) {
+        const int bit = qCountTrailingZeroBits(boundaries);
+        const int quotesBefore = qPopulationCount(quoteMask & ((quint64(1) << bit) - 1));
+        appendField(data, state.fieldStart, blockOffset + bit, state.fieldQuotes + quotesBefore - consumedQuotes, fields);
+        state.fieldStart = blockOffset + bit + 1;
+        state.fieldQuotes = 0;
+        consumedQuotes = quotesBefore;
+        boundaries &= boundaries - 1; // 清除最低位的1
+    }
+    state.fieldQuotes += qPopulationCount(quoteMask) - consumedQuotes;
+    state.inQuotes = (insideMask >> 63) != 0;
+}
+
+// 不足64字节的尾部复制到补零的缓冲区后按整块处理，各实现的尾部逻辑与主循环完全相同
+#define CSV_TOKENIZE_TAIL(maskFn, prefixXorFn)                                                   \
+    if (i < size) {                                                                              \
+        alignas(64) char tail[64] = {};                                                          \
+        std::memcpy(tail, data + i, static_cast<size_t>(size - i));                              \
+        const quint64 valid = (quint64(1) << (size - i)) - 1;                                    \
+        quint64 quoteMask;                                                                       \
+        quint64 delimiterMask;                                                                   \
+        maskFn(tail, delimiter, &quoteMask, &delimiterMask);                                     \
+        quoteMask &= valid;                                                                      \
+        delimiterMask &= valid & ~quoteMask;                                                     \
+        classifyBlock(data, quoteMask, delimiterMask,                                            \
+                      prefixXorFn(quoteMask) ^ QuoteMask::carry(state.inQuotes), i, state, fields); \
+    }                                                                                            \
+    appendField(data, state.fieldStart, size, state.fieldQuotes, fields);
+
+CSV_TARGET("sse4.2")
+inline void structuralMasksSse42(const char *block, char delimiter, quint64 *quoteMask, quint64 *delimiterMask)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i separator = _mm_set1_epi8(delimiter);
+    quint64 quotes = 0;
+    quint64 delimiters = 0;
+    for (int part = 0; part < 4; ++part) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block) + part);
+        quotes |= static_cast<quint64>(static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << (16 * part);
+        delimiters |= static_cast<quint64>(static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, separator)))) << (16 * part);
+    }
+    *quoteMask = quotes;
+    *delimiterMask = delimiters;
+}
+
+CSV_TARGET("avx2")
+inline void structuralMasksAvx2(const char *block, char delimiter, quint64 *quoteMask, quint64 *delimiterMask)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i separator = _mm256_set1_epi8(delimiter);
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block) + 1);
+    *quoteMask = static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote)))
+                 | (static_cast<quint64>(static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)))) << 32);
+    *delimiterMask = static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, separator)))
+                     | (static_cast<quint64>(static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, separator)))) << 32);
+}
+
+CSV_TARGET("avx512f,avx512bw")
+inline void structuralMasksAvx512(const char *block, char delimiter, quint64 *quoteMask, quint64 *delimiterMask)
+{
+    // 一次比较直接得到64位掩码
+    const __m512i chunk = _mm512_loadu_si512(block);
+    *quoteMask = _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8('"'));
+    *delimiterMask = _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(delimiter));
+}
+
+CSV_TARGET("sse4.2,popcnt,pclmul")
+void tokenizeSse42(const char *data, int size, char delimiter, QVector<FieldSpan> &fields)
+{
+    BlockState state;
+    int i = 0;
+    for (; i + 64 <= size; i += 64) {
+        quint64 quoteMask;
+        quint64 delimiterMask;
+        structuralMasksSse42(data + i, delimiter, &quoteMask, &delimiterMask);
+        delimiterMask &= ~quoteMask;
+        classifyBlock(data, quoteMask, delimiterMask,
+                      QuoteMask::prefixXorClmul(quoteMask) ^ QuoteMask::carry(state.inQuotes), i, state, fields);
+    }
+    CSV_TOKENIZE_TAIL(structuralMasksSse42, QuoteMask::prefixXorClmul)
+}
+
+CSV_TARGET("avx2,popcnt,pclmul")
+void tokenizeAvx2(const char *data, int size, char delimiter, QVector<FieldSpan> &fields)
+{
+    BlockState state;
+    int i = 0;
+    for (; i + 64 <= size; i += 64) {
+        quint64 quoteMask;
+        quint64 delimiterMask;
+        structuralMasksAvx2(data + i, delimiter, &quoteMask, &delimiterMask);
+        delimiterMask &= ~quoteMask;
+        classifyBlock(data, quoteMask, delimiterMask,
+                      QuoteMask::prefixXorClmul(quoteMask) ^ QuoteMask::carry(state.inQuotes), i, state, fields);
+    }
+    CSV_TOKENIZE_TAIL(structuralMasksAvx2, QuoteMask::prefixXorClmul)
+}
+
+CSV_TARGET("avx512f,avx512bw,popcnt,pclmul")
+void tokenizeAvx512(const char *data, int size, char delimiter, QVector<FieldSpan> &fields)
+{
+    BlockState state;
+    int i = 0;
+    for (; i + 64 <= size; i += 64) {
+        quint64 quoteMask;
+        quint64 delimiterMask;
+        structuralMasksAvx512(data + i, delimiter, &quoteMask, &delimiterMask);
+        delimiterMask &= ~quoteMask;
+        classifyBlock(data, quoteMask, delimiterMask,
+                      QuoteMask::prefixXorClmul(quoteMask) ^ QuoteMask::carry(state.inQuotes), i, state, fields);
+    }
+    CSV_TOKENIZE_TAIL(structuralMasksAvx512, QuoteMask::prefixXorClmul)
+}
+
+#undef CSV_TOKENIZE_TAIL
+
+#endif
+
+TokenizeFn resolveTokenize()
+{
+#if defined(CSV_SIMD_X86)
+    if (CpuFeatures::hasPopcnt() && CpuFeatures::hasPclmul()) {
+        if (CpuFeatures::hasAvx512bw()) {
+            return tokenizeAvx512;
+        }
+        if (CpuFeatures::hasAvx2()) {
+            return tokenizeAvx2;
+        }
+        if (CpuFeatures::hasSse42()) {
+            return tokenizeSse42;
+        }
+    }
+#endif
+    return tokenizeScalar;
+}
+
+// 首次使用时选定实现，之后直接调用函数指针
+TokenizeFn tokenizeImpl()
+{
+    static const TokenizeFn impl = resolveTokenize();
+    return impl;
+}
+
+TokenizeFn tokenizeFor(CodeUnit unit)
+{
+    switch (unit) {
+    case CodeUnit::Utf16LE:
+        return tokenizeWide<CodeUnit::Utf16LE>;
+    case CodeUnit::Utf16BE:
+        return tokenizeWide<CodeUnit::Utf16BE>;
+    default:
+        return tokenizeImpl();
+    }
+}
+
+}
+
+void CsvTokenizer::tokenize(const char *data, int size, char delimiter, QVector<FieldSpan> &fields, CodeUnit unit)
+{
+    fields.clear(); // clear保留容量，缓冲区在多条记录之间复用
+    tokenizeFor(unit)(data, size, delimiter, fields);
+}
+
+QString CsvTokenizer::implementationName()
+{
+#if defined(CSV_SIMD_X86)
+    if (CpuFeatures::hasPopcnt() && CpuFeatures::hasPclmul()) {
+        if (CpuFeatures::hasAvx512bw()) {
+            return QStringLiteral("AVX-512BW");
+        }
+        if (CpuFeatures::hasAvx2()) {
+            return QStringLiteral("AVX2");
+        }
+        if (CpuFeatures::hasSse42()) {
+            return QStringLiteral("SSE4.2");
+        }
+    }
+#endif
+    return QStringLiteral("Scalar");
+}
+
+QByteArray CsvTokenizer::unescape(const char *data, const FieldSpan &field, CodeUnit unit)
+{
+    const char *p = data + field.offset;
+    const int width = codeUnitSize(unit);
+    const int size = field.length - field.length % width;
+    QByteArray result;
+    result.reserve(size);
+    bool inQuotes = false;
+    for (int i = 0; i < size; i += width) {
+        if (loadCodeUnit(p + i, unit) == '"') {
+            if (inQuotes && i + width < size && loadCodeUnit(p + i + width, unit) == '"') {
+                // 引号内的双引号表示一个引号字符
+                result.append(p + i, width);
+                i += width;
+            } else {
+                // 其余引号只切换引号状态，不输出
+                inQuotes = !inQuotes;
+            }
+            continue;
+        }
+        result.append(p + i, width);
+    }
+    return result;
+}
+
+void CsvTokenizer::trim(const char *&data, int &size, CodeUnit unit)
+{
+    const int width = codeUnitSize(unit);
+    size -= size % width;
+    while (size > 0 && isAsciiSpace(loadCodeUnit(data, unit))) {
+        data += width;
+        size -= width;
+    }
+    while (size > 0 && isAsciiSpace(loadCodeUnit(data + size - width, unit))) {
+        size -= width;
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef CSVTOKENIZER_H
+#define CSVTOKENIZER_H
+
+#include <QVector>
+#include <QByteArray>
+#include <QString>
+#include "codeunit.h"
+
+/**
+ * @brief 记录中一个字段的位置，不持有数据
+ */
+struct FieldSpan {
+    int offset = 0;             // 字段在记录中的起始字节（整体被引号包围时已去掉外层引号）
+    int length = 0;             // 字段字节数
+    bool needsUnescape = false; // 字段中含有需要处理的引号，转为字符串前必须调用CsvTokenizer::unescape
+};
+
+/**
+ * @class CsvTokenizer
+ * @brief 在原始字节上切分CSV记录，只输出字段位置，不复制、不解码
+ *
+ * 分隔符和引号都是ASCII字符，UTF-8和GBK的多字节字符中不会出现这些字节，可以直接按字节切分；
+ * UTF-16按对齐的码元切分（标量实现），字段位置仍以字节为单位。
+ * 结果写入调用方复用的缓冲区，切分过程中不按字段分配内存；字段只在真正需要显示时才转为字符串。
+ * 引号规则：引号内成对的双引号表示一个引号字符，其余引号切换引号状态且本身不输出（""为空字段）。
+ *
+ * 切分按64字节块进行：向量化比较得到引号和分隔符的位掩码，引号掩码的前缀异或给出引号区域，
+ * 引号外的分隔符即字段边界。按运行时检测到的指令集选择AVX-512BW/AVX2/SSE4.2实现，
+ * 不支持时退回标量实现，各实现的输出完全一致。
+ */
+class CsvTokenizer
+{
+public:
+    /**
+     * @brief 切分一条记录
+     * @param data 记录起始地址（不含行尾换行符）
+     * @param size 记录字节数
+     * @param delimiter 分隔符
+     * @param fields 输出：清空后按顺序追加各字段位置，已有容量会被复用
+     * @param unit 码元宽度
+     */
+    static void tokenize(const char *data, int size, char delimiter, QVector<FieldSpan> &fields,
+                         CodeUnit unit = CodeUnit::Byte);
+
+    /**
+     * @brief 去掉字段中的引号，引号内的 "" 还原为一个 "
+     * @param data 记录起始地址
+     * @param field needsUnescape为true的字段
+     * @param unit 码元宽度，结果与输入的编码相同
+     */
+    static QByteArray unescape(const char *data, const FieldSpan &field, CodeUnit unit = CodeUnit::Byte);
+
+    /**
+     * @brief 当前选用的切分实现名称（"AVX-512BW"/"AVX2"/"SSE4.2"/"Scalar"）
+     */
+    static QString implementationName();
+
+    /**
+     * @brief 去掉首尾的ASCII空白字符（含行尾的\r\n）
+     * @param data 输入输出：记录起始地址
+     * @param size 输入输出：记录字节数
+     * @param unit 码元宽度
+     */
+    static void trim(const char *&data, int &size, CodeUnit unit = CodeUnit::Byte);
+};
+
+#endif // CSVTOKENIZER_H
@@ -0,0 +1,189 @@
+#include "gb18030.h"
+#include "cpufeatures.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+#if defined(CSV_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr char16_t ReplacementChar = 0xFFFD;
+
+// 把[data, data + size)开头的连续ASCII字节扩展为UTF-16写入out，返回处理的字节数
+using AsciiRunFn = int (*)(const uchar *, int, char16_t *);
+
+int asciiRunScalar(const uchar *data, int size, char16_t *out)
+{
+    int i = 0;
+    while (i < size && data[i] < 0x80) {
+        out[i] = data[i];
+        i++;
+    }
+    return i;
+}
+
+#if defined(CSV_SIMD_X86)
+
+// 每次把16个字节与0交错扩展为16个码元整块写出，再由最高位掩码确定其中有多少个ASCII字节。
+// 写出的非ASCII部分随后会被覆盖；输出码元数不超过输入字节数，整块写出不会越过out的容量
+CSV_TARGET("sse2")
+int asciiRunSse2(const uchar *data, int size, char16_t *out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i *dst = reinterpret_cast<__m128i *>(out + i);
+        _mm_storeu_si128(dst, _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(dst + 1, _mm_unpackhi_epi8(chunk, zero));
+        const int mask = _mm_movemask_epi8(chunk);
+        if (mask) {
+            return i + qCountTrailingZeroBits(static_cast<quint32>(mask));
+        }
+    }
+    return i + asciiRunScalar(data + i, size - i, out + i);
+}
+
+CSV_TARGET("avx2")
+int asciiRunAvx2(const uchar *data, int size, char16_t *out)
+{
+    int i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i *dst = reinterpret_cast<__m256i *>(out + i);
+        _mm256_storeu_si256(dst, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(chunk)));
+        _mm256_storeu_si256(dst + 1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(chunk, 1)));
+        const quint32 mask = static_cast<quint32>(_mm256_movemask_epi8(chunk));
+        if (mask) {
+            return i + qCountTrailingZeroBits(mask);
+        }
+    }
+    return i + asciiRunScalar(data + i, size - i, out + i);
+}
+
+#endif
+
+AsciiRunFn resolveAsciiRun()
+{
+#if defined(CSV_SIMD_X86)
+    if (CpuFeatures::hasAvx2()) {
+        return asciiRunAvx2;
+    }
+    if (CpuFeatures::hasSse2()) {
+        return asciiRunSse2;
+    }
+#endif
+    return asciiRunScalar;
+}
+
+// 首次使用时选定实现，之后直接调用函数指针
+AsciiRunFn asciiRunImpl()
+{
+    static const AsciiRunFn impl = resolveAsciiRun();
+    return impl;
+}
+
+inline bool isLeadByte(uchar ch)
+{
+    return ch >= 0x81 && ch <= 0xFE;
+}
+
+inline bool isDigitByte(uchar ch)
+{
+    return ch >= 0x30 && ch <= 0x39;
+}
+
+// BMP区段表中查找线性编号所在的区段
+inline char16_t fourByteBmp(int linear)
+{
+    const Gb18030::FourByteRange *begin = Gb18030::FourByteRanges;
+    const Gb18030::FourByteRange *end = begin + Gb18030::FourByteRangeCount;
+    const Gb18030::FourByteRange *range = std::upper_bound(begin, end, linear,
+        [](int value, const Gb18030::FourByteRange &r) { return value < r.linear; }) - 1;
+    return static_cast<char16_t>(range->codePoint + (linear - range->linear));
+}
+
+}
+
+int Gb18030::decode(const char *data, int size, char16_t *out)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    const AsciiRunFn asciiRun = asciiRunImpl();
+    int i = 0;
+    int o = 0;
+    while (i < size) {
+        const uchar b1 = p[i];
+        if (b1 < 0x80) {
+            const int run = asciiRun(p + i, size - i, out + o);
+            i += run;
+            o += run;
+            continue;
+        }
+        if (!isLeadByte(b1) || i + 1 >= size) {
+            out[o++] = ReplacementChar;
+            i++;
+            continue;
+        }
+
+        const uchar b2 = p[i + 1];
+        if (b2 >= 0x40 && b2 != 0x7F && b2 != 0xFF) {
+            // 双字节：尾字节跳过0x7F后连续编号
+            const int index = (b1 - 0x81) * 190 + (b2 < 0x7F ? b2 - 0x40 : b2 - 0x41);
+            out[o++] = static_cast<char16_t>(TwoByteTable[index]);
+            i += 2;
+            continue;
+        }
+
+        if (isDigitByte(b2) && i + 3 < size && isLeadByte(p[i + 2]) && isDigitByte(p[i + 3])) {
+            // 四字节：按 (b1, b2, b3, b4) 的混合进制计算线性编号
+            const int tail = ((b2 - 0x30) * 126 + (p[i + 2] - 0x81)) * 10 + (p[i + 3] - 0x30);
+            if (b1 <= 0x84) {
+                const int linear = (b1 - 0x81) * 12600 + tail;
+                if (linear < FourByteBmpCount) {
+                    out[o++] = fourByteBmp(linear);
+                    i += 4;
+                    continue;
+                }
+            } else if (b1 >= 0x90 && b1 <= 0xE3) {
+                const int linear = (b1 - 0x90) * 12600 + tail;
+                if (linear < 0x100000) {
+                    // 辅助平面按线性编号顺序映射，输出代理对
+                    out[o++] = static_cast<char16_t>(0xD800 + (linear >> 10));
+                    out[o++] = static_cast<char16_t>(0xDC00 + (linear & 0x3FF));
+                    i += 4;
+                    continue;
+                }
+            }
+        }
+
+        out[o++] = ReplacementChar;
+        i++;
+    }
+    return o;
+}
+
+QString Gb18030::toUnicode(const char *data, int size)
+{
+    if (!data || size <= 0) {
+        return QString();
+    }
+    QString result(size, Qt::Uninitialized);
+    const int length = decode(data, size, reinterpret_cast<char16_t *>(result.data()));
+    result.truncate(length);
+    return result;
+}
+
+QString Gb18030::implementationName()
+{
+#if defined(CSV_SIMD_X86)
+    if (CpuFeatures::hasAvx2()) {
+        return QStringLiteral("AVX2");
+    }
+    if (CpuFeatures::hasSse2()) {
+        return QStringLiteral("SSE2");
+    }
+#endif
+    return QStringLiteral("Scalar");
+}
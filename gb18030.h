@@ -0,0 +1,52 @@
+#ifndef GB18030_H
+#define GB18030_H
+
+#include <QtGlobal>
+#include <QString>
+
+/**
+ * @brief 查表实现的GB18030（兼容GBK、GB2312）解码器，不依赖系统区域设置和QTextCodec
+ *
+ * 单字节为ASCII；双字节（首字节0x81~0xFE，尾字节0x40~0x7E、0x80~0xFE）直接查码表；
+ * 四字节中映射到BMP的部分按区段表二分查找，映射到辅助平面的部分按线性编号直接计算并输出代理对。
+ * 连续的ASCII字节按运行时检测到的指令集（AVX2/SSE2）整块扩展为UTF-16，只有遇到非ASCII字节才逐个查表。
+ * 无效或截断的序列输出U+FFFD，并从下一个字节重新同步。
+ * 码表由tools/gen_gb18030_table.py生成，见gb18030table.cpp。
+ */
+namespace Gb18030 {
+
+// 四字节序列81308130~8431A439映射到BMP的一个连续区段
+struct FourByteRange {
+    quint16 linear;    // 区段起始的线性编号（0~39419）
+    quint16 codePoint; // 区段起始的码位，区段内线性编号与码位同步递增
+};
+
+constexpr int TwoByteTableSize = 126 * 190;
+constexpr int FourByteRangeCount = 206;
+constexpr int FourByteBmpCount = 39420; // 映射到BMP的四字节序列个数
+
+extern const quint16 TwoByteTable[TwoByteTableSize];
+extern const FourByteRange FourByteRanges[FourByteRangeCount];
+
+/**
+ * @brief 解码一段完整的GB18030文本
+ * @param data 输入字节
+ * @param size 输入字节数
+ * @param out 输出缓冲区，至少容纳size个UTF-16码元（输出码元数不会超过输入字节数）
+ * @return 写入out的码元数
+ */
+int decode(const char *data, int size, char16_t *out);
+
+/**
+ * @brief 解码为QString
+ */
+QString toUnicode(const char *data, int size);
+
+/**
+ * @brief 当前选用的ASCII扩展实现名称（"AVX2"/"SSE2"/"Scalar"）
+ */
+QString implementationName();
+
+}
+
+#endif // GB18030_H
@@ -0,0 +1,226 @@
+#include "indexcache.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QSharedPointer>
+#include <QDebug>
+#include <cstring>
+
+namespace {
+
+// 固定前缀：魔数、版本、序列化头部长度
+struct CacheFilePrefix {
+    quint32 magic;
+    quint32 version;
+    quint64 headerLength;
+};
+
+qint64 alignTo8(qint64 value)
+{
+    return (value + 7) & ~qint64(7);
+}
+
+}
+
+QString IndexCache::cachePath(const QString &fileName, Encoding requestedEncoding)
+{
+    // 指定编码时行边界和检测到的编码都可能不同，各自单独缓存；自动检测沿用原来的键，已有缓存仍然有效
+    QString keySource = QFileInfo(fileName).absoluteFilePath();
+    if (requestedEncoding != Encoding::AutoDetect) {
+        keySource += QString("|encoding=%1").arg(static_cast<int>(requestedEncoding));
+    }
+    const QByteArray key = QCryptographicHash::hash(keySource.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + "/row_index/" + QString::fromLatin1(key) + ".idx";
+}
+
+QByteArray IndexCache::fingerprint(QFile &file)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    const qint64 fileSize = file.size();
+    if (!file.seek(0)) {
+        return QByteArray();
+    }
+    hash.addData(file.read(qMin(fileSize, FingerprintBlockSize)));
+    if (fileSize > FingerprintBlockSize) {
+        if (!file.seek(qMax(FingerprintBlockSize, fileSize - FingerprintBlockSize))) {
+            return QByteArray();
+        }
+        hash.addData(file.read(FingerprintBlockSize));
+    }
+    return hash.result();
+}
+
+bool IndexCache::load(const QString &fileName, Encoding requestedEncoding, CsvInitializationData &data)
+{
+    QFileInfo sourceInfo(fileName);
+    if (sourceInfo.size() < MinCachedFileSize) {
+        return false;
+    }
+
+    const QString path = cachePath(fileName, requestedEncoding);
+    QSharedPointer<QFile> cacheFile(new QFile(path));
+    if (!cacheFile->exists() || !cacheFile->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 cacheSize = cacheFile->size();
+    if (cacheSize < static_cast<qint64>(sizeof(CacheFilePrefix))) {
+        cacheFile->close();
+        QFile::remove(path);
+        return false;
+    }
+    const uchar *memory = cacheFile->map(0, cacheSize);
+    if (!memory) {
+        qDebug() << "Cannot map index cache:" << path;
+        return false;
+    }
+
+    CacheFilePrefix prefix;
+    std::memcpy(&prefix, memory, sizeof(prefix));
+    if (prefix.magic != Magic || prefix.version != Version
+        || prefix.headerLength > static_cast<quint64>(cacheSize) - sizeof(prefix)) {
+        qDebug() << "Index cache format mismatch, rebuilding:" << path;
+        cacheFile->close();
+        QFile::remove(path);
+        return false;
+    }
+
+    const QByteArray header = QByteArray::fromRawData(reinterpret_cast<const char *>(memory + sizeof(prefix)),
+                                                      static_cast<int>(prefix.headerLength));
+    QDataStream stream(header);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    QString sourcePath;
+    qint64 sourceSize = 0;
+    qint64 sourceModified = 0;
+    QByteArray sourceFingerprint;
+    qint32 encoding = 0;
+    QString delimiter;
+    QVector<QString> headers;
+    qint64 rowCount = 0;
+    qint32 stride = 1;
+    qint64 checkpointCount = 0;
+    QHash<qint64, qint64> overflowOffsets;
+    qint64 blockBasesOffset = 0;
+    qint64 relativeOffsetsOffset = 0;
+    stream >> sourcePath >> sourceSize >> sourceModified >> sourceFingerprint
+           >> encoding >> delimiter >> headers
+           >> rowCount >> stride >> checkpointCount >> overflowOffsets
+           >> blockBasesOffset >> relativeOffsetsOffset;
+
+    const qint64 blockCount = (checkpointCount + (1 << RowIndex::BlockShift) - 1) >> RowIndex::BlockShift;
+    const bool layoutValid = stream.status() == QDataStream::Ok
+                             && stride > 0 && checkpointCount >= 0
+                             && blockBasesOffset % 8 == 0 && relativeOffsetsOffset % 4 == 0
+                             && blockBasesOffset + blockCount * static_cast<qint64>(sizeof(qint64)) <= cacheSize
+                             && relativeOffsetsOffset + checkpointCount * static_cast<qint64>(sizeof(quint32)) <= cacheSize;
+
+    // 源文件的大小、修改时间和首尾内容都必须与建立缓存时一致
+    bool upToDate = layoutValid
+                    && sourcePath == sourceInfo.absoluteFilePath()
+                    && sourceSize == sourceInfo.size()
+                    && sourceModified == sourceInfo.lastModified().toMSecsSinceEpoch();
+    if (upToDate) {
+        QFile source(fileName);
+        upToDate = source.open(QIODevice::ReadOnly) && fingerprint(source) == sourceFingerprint;
+    }
+    if (!upToDate) {
+        qDebug() << "Index cache is stale, rebuilding:" << path;
+        cacheFile->close();
+        QFile::remove(path);
+        return false;
+    }
+
+    data.headers = headers;
+    data.delimiter = delimiter;
+    data.encoding = static_cast<Encoding>(encoding);
+    data.totalRows = rowCount;
+
+    RowIndex &index = data.rowIndex;
+    index.clear();
+    index.m_rowCount = rowCount;
+    index.m_stride = stride;
+    index.m_overflowOffsets = overflowOffsets;
+    index.m_mappedBlockBases = reinterpret_cast<const qint64 *>(memory + blockBasesOffset);
+    index.m_mappedRelativeOffsets = reinterpret_cast<const quint32 *>(memory + relativeOffsetsOffset);
+    index.m_mappedCheckpointCount = checkpointCount;
+    index.m_mappedFile = cacheFile; // 映射随RowIndex的最后一个副本释放
+
+    qDebug() << "已从缓存加载行索引:" << path << "总行数:" << rowCount;
+    return true;
+}
+
+bool IndexCache::save(const QString &fileName, Encoding requestedEncoding, const CsvInitializationData &data,
+                      qint64 indexedSize)
+{
+    QFileInfo sourceInfo(fileName);
+    if (sourceInfo.size() < MinCachedFileSize || data.rowIndex.isEmpty()) {
+        return false;
+    }
+    if (sourceInfo.size() != indexedSize) {
+        return false; // 文件在建立索引期间发生了变化，索引没有覆盖全部内容
+    }
+
+    QFile source(fileName);
+    if (!source.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray sourceFingerprint = fingerprint(source);
+    source.close();
+
+    const RowIndex &index = data.rowIndex;
+    const qint64 checkpointCount = index.checkpointCount();
+    const qint64 blockCount = (checkpointCount + (1 << RowIndex::BlockShift) - 1) >> RowIndex::BlockShift;
+
+    // 头部中要记录数组偏移，而偏移又取决于头部长度：先用占位值序列化一次得到长度。
+    // 所有字段都是定长或已知内容，两次序列化长度相同。
+    auto serializeHeader = [&](qint64 blockBasesOffset, qint64 relativeOffsetsOffset) {
+        QByteArray header;
+        QDataStream stream(&header, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << sourceInfo.absoluteFilePath() << sourceInfo.size()
+               << sourceInfo.lastModified().toMSecsSinceEpoch() << sourceFingerprint
+               << static_cast<qint32>(data.encoding) << data.delimiter << data.headers
+               << index.rowCount() << static_cast<qint32>(index.stride()) << checkpointCount
+               << index.m_overflowOffsets
+               << blockBasesOffset << relativeOffsetsOffset;
+        return header;
+    };
+    const qint64 headerLength = serializeHeader(0, 0).size();
+    const qint64 blockBasesOffset = alignTo8(static_cast<qint64>(sizeof(CacheFilePrefix)) + headerLength);
+    const qint64 relativeOffsetsOffset = blockBasesOffset + blockCount * static_cast<qint64>(sizeof(qint64));
+    const QByteArray header = serializeHeader(blockBasesOffset, relativeOffsetsOffset);
+
+    const QString path = cachePath(fileName, requestedEncoding);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    // QSaveFile先写临时文件再原子替换，写入中途失败不会留下损坏的缓存
+    QSaveFile cacheFile(path);
+    if (!cacheFile.open(QIODevice::WriteOnly)) {
+        qDebug() << "Cannot write index cache:" << path;
+        return false;
+    }
+
+    CacheFilePrefix prefix;
+    prefix.magic = Magic;
+    prefix.version = Version;
+    prefix.headerLength = static_cast<quint64>(header.size());
+    cacheFile.write(reinterpret_cast<const char *>(&prefix), sizeof(prefix));
+    cacheFile.write(header);
+    cacheFile.write(QByteArray(static_cast<int>(blockBasesOffset - sizeof(prefix) - header.size()), '\0'));
+    cacheFile.write(reinterpret_cast<const char *>(index.blockBases()), blockCount * static_cast<qint64>(sizeof(qint64)));
+    cacheFile.write(reinterpret_cast<const char *>(index.relativeOffsets()), checkpointCount * static_cast<qint64>(sizeof(quint32)));
+    if (!cacheFile.commit()) {
+        qDebug() << "Failed to commit index cache:" << path;
+        return false;
+    }
+
+    qDebug() << "行索引已写入缓存:" << path;
+    return true;
+}
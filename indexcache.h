@@ -0,0 +1,55 @@
+#ifndef INDEXCACHE_H
+#define INDEXCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include "csvreader.h"
+
+class QFile;
+
+/**
+ * @class IndexCache
+ * @brief 行索引的磁盘缓存，重新打开未修改的大文件时无需重新扫描
+ *
+ * 缓存文件位于系统缓存目录下，以源文件绝对路径（指定编码时再加上编码）的哈希命名，保存行索引、编码、分隔符和表头。
+ * 缓存以源文件的大小、修改时间以及首尾内容指纹为键，任一不一致即视为过期，删除后重新建立。
+ * 检查点数组按8字节对齐存放，加载时直接内存映射，不做复制。
+ */
+class IndexCache
+{
+public:
+    /**
+     * @brief 尝试从缓存加载初始化数据
+     * @param fileName CSV文件路径
+     * @param requestedEncoding 用户选择的编码，只加载以同一选择建立的缓存
+     * @param data 输出：加载成功时填充表头、分隔符、编码、总行数和映射的行索引
+     * @return 缓存存在且与源文件一致时返回true
+     */
+    static bool load(const QString &fileName, Encoding requestedEncoding, CsvInitializationData &data);
+
+    /**
+     * @brief 将完整建立的初始化数据写入缓存
+     * @param fileName CSV文件路径
+     * @param requestedEncoding 建立索引时用户选择的编码
+     * @param data 已完成索引的初始化数据
+     * @param indexedSize 索引覆盖的文件字节数，与当前文件大小不一致（索引期间文件被追加）时不写入
+     * @return 写入成功返回true，小文件不缓存也返回false
+     */
+    static bool save(const QString &fileName, Encoding requestedEncoding, const CsvInitializationData &data,
+                     qint64 indexedSize);
+
+    /**
+     * @brief 指定CSV文件在给定编码选择下对应的缓存文件路径
+     */
+    static QString cachePath(const QString &fileName, Encoding requestedEncoding);
+
+private:
+    static constexpr quint32 Magic = 0x43535649; // "CSVI"
+    static constexpr quint32 Version = 2;         // 格式变化时递增，旧缓存自动失效
+    static constexpr qint64 MinCachedFileSize = 16LL * 1024 * 1024; // 小文件重新扫描已足够快
+    static constexpr qint64 FingerprintBlockSize = 64 * 1024;
+
+    static QByteArray fingerprint(QFile &file); // 文件首尾各64KB内容的指纹
+};
+
+#endif // INDEXCACHE_H
@@ -11,7 +11,6 @@ int main(int argc, char *argv[])
     qRegisterMetaType<CsvRowData>("CsvRowData");
     qRegisterMetaType<Encoding>("Encoding");
     qRegisterMetaType<QVector<QString>>("QVector<QString>");
-    qRegisterMetaType<QMap<qint64, qint64>>("QMap<qint64, qint64>");
     qRegisterMetaType<QMap<QString, qint64>>("QMap<QString, qint64>");
     qRegisterMetaType<QVector<QStringList>>("QVector<QStringList>");
     
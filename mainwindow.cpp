@@ -2,6 +2,7 @@
 #include "./ui_mainwindow.h"
 #include "csvreader.h"
 #include "tablemodel.h"  // 添加包含
+#include "csvgridview.h"
 #include <QVBoxLayout>
 #include <QScrollArea>
 #include <QWidget>
@@ -16,6 +17,7 @@
 #include <QKeyEvent>     // 添加键盘事件头文件
 #include <QInputDialog>  // 添加输入对话框头文件
 #include <QMessageBox>   // 添加消息框头文件
+#include <climits>
 
 // 定义DEBUG_PRINT宏，如果未定义则设为qDebug()输出调试信息
 #ifndef DEBUG_PRINT
@@ -32,7 +34,7 @@ MainWindow::MainWindow(QWidget *parent)
     , m_workerThread(new QThread)
     , m_delayedLoadTimer(new QTimer(this))
     , m_scrollBarResetTimer(new QTimer(this))
-    , m_preloadTimer(new QTimer(this))
+    , m_frameTimer(new QTimer(this))
     , m_totalRows(0)
     , m_visibleRows(100) // 默认显示100行
     , m_currentStartRow(0) // 初始化当前起始行
@@ -80,12 +82,10 @@ MainWindow::MainWindow(QWidget *parent)
     // 将数据模型设置到tableView中
     ui->tableView->setModel(m_tableModel);
     
-    // 设置固定行高并启用文本换行
-    ui->tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
-    ui->tableView->verticalHeader()->setDefaultSectionSize(m_defaultRowHeight);
-    ui->tableView->setWordWrap(true);
+    // 设置固定行高（CsvGridView按单行绘制单元格，超出列宽的部分截断）
+    ui->tableView->setRowHeight(m_defaultRowHeight);
     
-    // 禁用QTableView自带的垂直滚动条
+    // 禁用表格视图自带的垂直滚动条，纵向位置由外部滚动条决定
     ui->tableView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
 
     // 将CsvReader移动到工作线程
@@ -94,8 +94,17 @@ MainWindow::MainWindow(QWidget *parent)
 
     // 连接信号和槽
     connect(this, &MainWindow::initCsvReader, m_csvReader, &CsvReader::init);
-    connect(this, &MainWindow::requestRowsData, m_csvReader, &CsvReader::readRows); // 连接请求数据行的信号和槽
-    connect(this, &MainWindow::requestPreloadData, m_csvReader, &CsvReader::readRows); // 连接预加载数据请求信号和槽
+    // 读取请求直接提交到读取线程的调度器（线程安全），不在工作线程的事件队列中排在预加载之后
+    connect(this, &MainWindow::requestRowsData, this, [this](qint64 startRow, qint64 rowCount, quint64 generation) {
+        m_csvReader->submitRead(startRow, rowCount, generation, ReadPriority::Visible, m_projection);
+    });
+    connect(this, &MainWindow::requestPreloadData, this, [this](qint64 startRow, qint64 rowCount, quint64 generation) {
+        m_csvReader->submitRead(startRow, rowCount, generation, ReadPriority::Prefetch, m_projection);
+    });
+    connect(this, &MainWindow::followModeChanged, m_csvReader, &CsvReader::setFollowMode);
+    // 行块缓存只在工作线程访问，预算经排队连接在工作线程中设置
+    connect(this, &MainWindow::blockCacheBudgetsChanged, m_csvReader, &CsvReader::setBlockCacheBudgets);
+    applyBlockCacheBudgets();
     
     // 创建一个定时器用于重置滚动条颜色
     m_scrollBarResetTimer = new QTimer(this);
@@ -103,22 +112,40 @@ MainWindow::MainWindow(QWidget *parent)
     connect(m_scrollBarResetTimer, &QTimer::timeout, this, &MainWindow::resetScrollBarColor);
     connect(m_csvReader, &CsvReader::initializationDataReady, 
             this, &MainWindow::onInitializationDataReceived);
-    connect(m_csvReader, &CsvReader::rowDataReady, 
-            this, &MainWindow::onRowsDataReceived); // 连接数据行读取完成的信号和槽
+    connect(m_csvReader, &CsvReader::indexProgress,
+            this, &MainWindow::onIndexProgress);
+    connect(m_csvReader, &CsvReader::rowCountEstimated,
+            this, &MainWindow::onRowCountEstimated);
+    connect(m_csvReader, &CsvReader::fileAppended,
+            this, &MainWindow::onFileAppended);
+    // 读取结果经无锁通道传递，信号只是通知，结果在下一帧统一取出
+    connect(m_csvReader, &CsvReader::rowDataAvailable,
+            this, &MainWindow::onRowDataAvailable);
+    m_frameTimer->setSingleShot(true);
+    connect(m_frameTimer, &QTimer::timeout, this, &MainWindow::drainRowData);
 
     // 连接滚动条信号和槽
     connect(ui->verticalScrollBar, &QScrollBar::valueChanged,
             this, &MainWindow::onVerticalScrollBarValueChanged);
+    // 表格按像素平滑滚动，满一行时移动滚动条；滚动条到两端时表格不再保留行内偏移
+    connect(ui->tableView, &CsvGridView::rowsScrolled, this, [this](int rows) {
+        ui->verticalScrollBar->setValue(qBound(0, ui->verticalScrollBar->value() + rows,
+                                               ui->verticalScrollBar->maximum()));
+    });
+    auto updateScrollBounds = [this]() {
+        const QScrollBar *bar = ui->verticalScrollBar;
+        ui->tableView->setScrollBounds(bar->value() <= bar->minimum(), bar->value() >= bar->maximum());
+    };
+    connect(ui->verticalScrollBar, &QScrollBar::valueChanged, this, updateScrollBounds);
+    connect(ui->verticalScrollBar, &QScrollBar::rangeChanged, this, updateScrollBounds);
+    // 每帧的绘制耗时在下次刷新状态栏时显示
+    connect(ui->tableView, &CsvGridView::frameRendered, m_statusManager, &StatusManager::setFrameStats);
     // 保存当前起始行为初始值
     m_currentStartRow = ui->verticalScrollBar->value();
     
     // 设置延迟加载定时器
     m_delayedLoadTimer->setSingleShot(true);
     connect(m_delayedLoadTimer, &QTimer::timeout, this, &MainWindow::onDelayedLoad);
-    
-    // 设置预加载定时器
-    m_preloadTimer->setSingleShot(true);
-    connect(m_preloadTimer, &QTimer::timeout, this, &MainWindow::onPreloadTimeout);
 
     //init
     ui->dockWidget->hide();
@@ -154,11 +181,14 @@ MainWindow::MainWindow(QWidget *parent)
     m_contextMenu->addAction(highlightColumnAction);
     
     ui->tableView->setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(ui->tableView, &QTableView::customContextMenuRequested, this, &MainWindow::showContextMenu);
+    connect(ui->tableView, &CsvGridView::customContextMenuRequested, this, &MainWindow::showContextMenu);
 }
 
 MainWindow::~MainWindow()
 {
+    // 作废所有请求并唤醒等待读取结果通道空位的工作线程，之后不再有界面取走结果
+    m_workerThread->requestInterruption();
+    m_csvReader->cancelRequestsBefore(m_requestGeneration + 1);
     m_workerThread->quit();
     m_workerThread->wait();
     delete m_csvReader;
@@ -178,6 +208,7 @@ void MainWindow::on_action_open_triggered()
         m_fileName = fileName;
         // 发送文件名给CsvReader进行初始化
         m_statusManager->startTiming(tr("文件初始化"));
+        m_statusManager->startTiming(tr("建立行索引"));
         emit initCsvReader(fileName);
         // 注意：这里不会立即结束计时，因为是异步操作
         // 实际的计时结束会在onInitializationDataReceived中处理
@@ -250,6 +281,14 @@ void MainWindow::on_pushButton_filter_clicked()
     // 获取新的筛选列索引
     QVector<int> newSelectedColumns = m_tableModel->getSelectedColumnIndexes();
     
+    // 之后的读取请求都带上列投影，未选中的列只切分不复制；全部选中时不做投影
+    m_projection = newSelectedColumns.size() == m_headers.size() ? QVector<int>() : newSelectedColumns;
+    if (m_totalRows > 0) {
+        // 已加载的行只含旧投影中的列，按新投影重新读取当前窗口，预加载不沿用之前的滚动速度
+        m_prefetcher.resetVelocity();
+        handleLargeScroll(ui->verticalScrollBar->value());
+    }
+    
     // 找出新增的筛选列（新的列索引在之前未被选中）
     QVector<int> newHighlightedColumns;
     for (int columnIndex : newSelectedColumns) {
@@ -382,6 +421,9 @@ void MainWindow::onInitializationDataReceived(const QVector<QString> &headers)
     // 清空之前的数据
     m_tableModel->clear();
     
+    // 新文件的列不同，之后的请求读取全部列
+    m_projection.clear();
+    
     // 根据表头生成复选框
     generateColumnCheckboxes(headers);
     
@@ -393,21 +435,20 @@ void MainWindow::onInitializationDataReceived(const QVector<QString> &headers)
     
     // 保存总行数（从CsvReader获取）
     m_totalRows = m_csvReader->getTotalRows();
+    m_indexedRows = m_totalRows;
+    m_rowCountExact = false; // 随后的indexProgress/rowCountEstimated会给出精确值或估计值
+    m_rowCountError = 1.0;
+    m_prefetcher.resetVelocity(); // 上一个文件的滚动速度不适用于新文件
     
     qDebug() << "总行数设置为:" << m_totalRows << ", 可视行数:" << m_visibleRows;
     
     // 更新滚动条范围
     updateScrollBarRange();
 
-    emit requestRowsData(1, m_visibleRows); // 从第1行开始读取可视行数（跳过表头）
+    emit requestRowsData(1, m_visibleRows, nextRequestGeneration()); // 从第1行开始读取可视行数（跳过表头）
     
-    // 初始化TableView的滚动条
-    QScrollBar* tableViewScrollBar = ui->tableView->verticalScrollBar();
-    if (tableViewScrollBar) {
-        tableViewScrollBar->setRange(0, m_totalRows - m_visibleRows);
-        tableViewScrollBar->setPageStep(m_visibleRows);
-        qDebug() << "初始化TableView滚动条: 范围0-" << (m_totalRows - m_visibleRows) << ", 步长=" << m_visibleRows;
-    }
+    // 绘制耗时从新文件开始统计
+    ui->tableView->resetFrameStats();
     
     // 结束文件初始化计时
     m_statusManager->endTiming(tr("文件初始化"));
@@ -415,9 +456,128 @@ void MainWindow::onInitializationDataReceived(const QVector<QString> &headers)
     m_statusManager->updateStatusBar();
 }
 
+void MainWindow::onIndexProgress(qint64 totalRows, bool finished)
+{
+    if (m_fileName.isEmpty()) {
+        return;
+    }
+    
+    // 当前页面此前超出已索引范围（按估计行数滚动过去的），索引覆盖到之后重新加载
+    const qint64 viewEndRow = m_currentStartRow + m_visibleRows;
+    const bool viewBecameReadable = viewEndRow >= m_indexedRows && viewEndRow < totalRows;
+    m_indexedRows = totalRows;
+    
+    // 索引完成后改用精确行数；完成前滚动条范围取估计值与已索引行数中较大者，当前滚动位置保持不变
+    const qint64 displayRows = finished ? totalRows : qMax(m_totalRows, totalRows);
+    m_rowCountExact = finished;
+    if (displayRows != m_totalRows) {
+        m_totalRows = displayRows;
+        updateScrollBarRange();
+    }
+    if (viewBecameReadable) {
+        handleLargeScroll(ui->verticalScrollBar->value());
+    }
+    
+    if (finished) {
+        qDebug() << "行索引建立完成: 总行数=" << m_totalRows;
+        m_statusManager->endTiming(tr("建立行索引"));
+        m_statusManager->updateStatusBar();
+    } else {
+        updateIndexingStatus();
+    }
+}
+
+void MainWindow::onRowCountEstimated(qint64 estimatedRows, double relativeError)
+{
+    if (m_fileName.isEmpty() || m_rowCountExact) {
+        return;
+    }
+    
+    // 估计值立即用于滚动条范围，之后随索引推进收敛到精确值
+    m_rowCountError = relativeError;
+    const qint64 displayRows = qMax(estimatedRows, m_indexedRows);
+    if (displayRows != m_totalRows) {
+        m_totalRows = displayRows;
+        updateScrollBarRange();
+    }
+    updateIndexingStatus();
+}
+
+void MainWindow::updateIndexingStatus()
+{
+    // 总行数为估计值时以"~"标出，并附上置信区间
+    m_statusManager->updateStatusBar(tr("[~%1行 (±%2%)，正在建立索引: 已索引%3行]")
+                                         .arg(m_totalRows)
+                                         .arg(m_rowCountError * 100, 0, 'f', 1)
+                                         .arg(m_indexedRows));
+}
+
+void MainWindow::onFileAppended(qint64 totalRows)
+{
+    if (m_fileName.isEmpty()) {
+        return;
+    }
+    
+    // 追加前是否正在查看末尾：最后一行的内容可能因追加而补全，需要刷新
+    const bool viewingTail = m_currentStartRow + m_visibleRows >= m_totalRows - 1;
+    m_indexedRows = totalRows;
+    m_totalRows = totalRows;
+    updateScrollBarRange();
+    
+    if (ui->action_auto_scroll->isChecked()) {
+        const int lastPage = ui->verticalScrollBar->maximum();
+        m_internalScrollBarChange = true; // 由下面的handleLargeScroll加载，滚动条的变化不再触发读取
+        ui->verticalScrollBar->setValue(lastPage);
+        m_internalScrollBarChange = false;
+        handleLargeScroll(lastPage);
+    } else if (viewingTail) {
+        handleLargeScroll(ui->verticalScrollBar->value());
+    }
+    m_statusManager->updateStatusBar(tr("[跟踪中: 共%1行]").arg(m_totalRows));
+}
+
+void MainWindow::onRowDataAvailable()
+{
+    if (m_frameTimer->isActive()) {
+        return;
+    }
+    // 距上次取结果不足一帧时等到下一帧，空闲时立即取
+    const qint64 elapsed = QDateTime::currentMSecsSinceEpoch() - m_lastDrainAt;
+    m_frameTimer->start(int(qBound<qint64>(0, FrameIntervalMs - elapsed, FrameIntervalMs)));
+}
+
+void MainWindow::drainRowData()
+{
+    m_lastDrainAt = QDateTime::currentMSecsSinceEpoch();
+    QVector<ReadResult> results;
+    if (m_csvReader->takeRowData(&results) == 0) {
+        return;
+    }
+    
+    // 所有结果在一次批量更新中应用，视图只收到一次重置或一次变化通知，只布局一次
+    m_tableModel->beginUpdate();
+    for (const ReadResult &result : results) {
+        // 跳转或大范围滚动之前发出的请求，其结果可能已在通道中，不再应用
+        if (result.generation != m_requestGeneration) {
+            continue;
+        }
+        onRowsDataReceived(result.rowData, result.startRow);
+    }
+    m_tableModel->endUpdate();
+    
+    // 整批结果应用后补充前后的数据，连续滚动时预加载始终走在可视区域前面
+    if (m_prefetchDue) {
+        m_prefetchDue = false;
+        schedulePrefetch();
+    }
+}
+
 void MainWindow::onRowsDataReceived(const struct CsvRowData &rowData, qint64 startRow)
 {
-    if(startRow != m_currentStartRow+1)
+    m_statusManager->setQueueStats(rowData.queueStats);
+    m_statusManager->setCacheStats(rowData.cacheStats);
+    m_prefetcher.recordBlock(rowData.rows.size(), rowData.rows.memoryUsage());
+    if(startRow == m_pendingFront.startRow || startRow == m_pendingBack.startRow || startRow != m_currentStartRow+1)
     {
         PreloadedDataReceived(rowData,startRow);
         return;
@@ -440,20 +600,16 @@ void MainWindow::onRowsDataReceived(const struct CsvRowData &rowData, qint64 sta
         qDebug() << "第一行第一列数据=" << firstData.toString();
     }
 #endif
-    // 强制刷新视图
+    // 强制刷新视图（模型重置时视图已回到第一行的顶部，不保留行内的像素偏移）
     ui->tableView->viewport()->update();
     
-    // 直接滚动到顶部以确保显示正确位置的数据
-    if (rowData.rows.size() > 0) {
-        QModelIndex firstIndex = m_tableModel->index(0, 0);
-        ui->tableView->scrollTo(firstIndex, QAbstractItemView::PositionAtTop);
-        qDebug() << "已滚动到第一行数据";
-    }
-    
     // 更新当前起始行
     m_currentStartRow = startRow;
     
     m_statusManager->endTiming(tr("加载数据"));
+    
+    // 可视区域就绪后立即补充前后的数据
+    m_prefetchDue = true;
 }
 
 void MainWindow::generateColumnCheckboxes(const QVector<QString> &headers)
@@ -518,6 +674,13 @@ void MainWindow::onVerticalScrollBarValueChanged(int value)
     qDebug() << "滚动条值变化: value=" << value << ", 当前起始行=" << m_currentStartRow;
     int currentValue = ui->verticalScrollBar->value();
     
+    if (m_internalScrollBarChange) {
+        // 跳转或跟踪末尾时由调用方直接加载，这里只记录位置，不再发出第二次读取
+        m_lastScrollPosition = currentValue;
+        m_currentStartRow = currentValue;
+        return;
+    }
+    
     // 每次滚动时重启滚动条重置定时器
     m_scrollBarResetTimer->start(1000); // 1秒后重置滚动条样式
     
@@ -553,9 +716,11 @@ void MainWindow::onVerticalScrollBarValueChanged(int value)
     );
     
     // 检查是否需要加载新数据
+    m_prefetcher.recordScroll(currentValue, QDateTime::currentMSecsSinceEpoch());
     ScrollType scrollType = detectScrollType(m_lastScrollPosition, currentValue);
 
-    if (scrollType == LARGE_SCROLL)
+    // 连续滚动累计的距离再大，只要目标位置已预加载就按小范围滚动处理
+    if (scrollType == LARGE_SCROLL && !m_tableModel->containsRows(currentValue + 1, m_visibleRows))
     {
         // 当滚动条值变化时，启动延迟加载定时器
         m_delayedLoadTimer->start(200); // 200ms延迟
@@ -603,7 +768,6 @@ void MainWindow::wheelEvent(QWheelEvent *event)
              << ", oldValue=" << oldValue << ", newValue=" << newScrollBarValue;
     
     // 更新滚动条值（会触发onVerticalScrollBarValueChanged）
-    m_internalScrollBarChange = true;
     ui->verticalScrollBar->setValue(newScrollBarValue);
     
     // 接受事件
@@ -654,7 +818,6 @@ void MainWindow::keyPressEvent(QKeyEvent *event)
     // 更新滚动条值
     if (newScrollBarValue != currentScrollBarValue) {
         qDebug() << "更新滚动条值: " << currentScrollBarValue << " -> " << newScrollBarValue;
-        m_internalScrollBarChange = true;
         ui->verticalScrollBar->setValue(newScrollBarValue);
     }
     
@@ -705,42 +868,59 @@ void MainWindow::onDelayedLoad()
     handleLargeScroll(currentValue);
 }
 
-void MainWindow::onPreloadTimeout()
+quint64 MainWindow::nextRequestGeneration()
 {
-    int currentValue = ui->verticalScrollBar->value();
-    qDebug() << "预加载触发: currentValue=" << currentValue;
-    
-    // 执行预加载
-    preloadData(currentValue + 1);
+    // 直接写入读取线程的原子变量，不经过事件队列，排队中的旧请求在执行前即可看到
+    m_requestGeneration++;
+    m_csvReader->cancelRequestsBefore(m_requestGeneration);
+    return m_requestGeneration;
 }
 
-// 预加载数据函数
-void MainWindow::preloadData(qint64 centerRow)
+// 按预加载器的计划补充可视区域前后的数据：沿滚动方向多读，剩余不足目标的一半时才请求，
+// 每侧同时只有一个请求在读取
+void MainWindow::schedulePrefetch()
 {
-    // 计算预加载范围：前后各m_visibleRows行
-    // 防止读取表头
-    qint64 preStartRow = qMax(1LL, centerRow - m_visibleRows);
-    qint64 postEndRow = qMin(m_totalRows - 1, centerRow + 2 * m_visibleRows - 1);
-    
-    qDebug() << "预加载数据: 中心行=" << centerRow 
-             << ", 前置范围=[" << preStartRow << "," << (centerRow-1) << "]"
-             << ", 后置范围=[" << (centerRow + m_visibleRows) << "," << postEndRow << "]";
-    
-    // 请求预加载前置数据
-    if (preStartRow < centerRow) {
-        qint64 rowCount = centerRow - preStartRow;
-        emit requestPreloadData(preStartRow, rowCount);
-        qDebug() << "请求前置预加载数据: 起始行=" << (preStartRow) << ", 行数=" << rowCount;
+    if (m_tableModel->getFullDataSize() == 0 || m_visibleRows <= 0) {
+        return;
+    }
+    m_prefetcher.setVisibleRows(m_visibleRows);
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const Prefetcher::Plan plan = m_prefetcher.plan(now);
+    m_tableModel->setScrollDirection(plan.direction);
+    m_tableModel->setMaxDataRows(int(qMin<qint64>(m_prefetcher.maxWindowRows(), INT_MAX)));
+    const qint64 wantBefore = plan.direction < 0 ? plan.aheadRows : plan.behindRows;
+    const qint64 wantAfter = plan.direction < 0 ? plan.behindRows : plan.aheadRows;
+    
+    const qint64 dataStart = m_tableModel->getFullDataStartRow();
+    const qint64 dataEnd = dataStart + m_tableModel->getFullDataSize(); // 不含
+    const qint64 visibleStart = m_tableModel->getCurrentWindowStartRow();
+    const qint64 visibleEnd = visibleStart + m_visibleRows;
+    const qint64 lastRow = m_indexedRows - 1; // 可以读取的最后一行
+    
+    PRINT_DEBUG(QString("预加载计划: 方向=%1, 速度=%2行/秒, 延迟=%3ms, 前方=%4, 后方=%5, 窗口上限=%6")
+                .arg(plan.direction).arg(m_prefetcher.velocity(), 0, 'f', 1).arg(m_prefetcher.latencyMs(), 0, 'f', 1)
+                .arg(wantBefore).arg(wantAfter).arg(m_prefetcher.maxWindowRows()));
+    
+    // 请求前置数据，防止读取表头
+    const qint64 preStartRow = qMax<qint64>(1, visibleStart - wantBefore);
+    if (m_pendingFront.startRow < 0 && preStartRow < dataStart && (visibleStart - dataStart) * 2 < wantBefore) {
+        const qint64 rowCount = dataStart - preStartRow;
+        emit requestPreloadData(preStartRow, rowCount, m_requestGeneration);
+        m_pendingFront.startRow = preStartRow;
+        m_pendingFront.requestedAt = now;
+        qDebug() << "请求前置预加载数据: 起始行=" << preStartRow << ", 行数=" << rowCount;
         m_statusManager->startTiming(tr("预加载前方数据"));
     }
     
-    // 请求预加载后置数据
-    qint64 postStartRow = centerRow + m_visibleRows;
-    if (postStartRow <= postEndRow) {
-        qint64 rowCount = postEndRow - postStartRow;
-        emit requestPreloadData(postStartRow, rowCount);
+    // 请求后置数据
+    const qint64 postEndRow = qMin(lastRow, visibleEnd + wantAfter - 1);
+    if (m_pendingBack.startRow < 0 && dataEnd <= postEndRow && (dataEnd - visibleEnd) * 2 < wantAfter) {
+        const qint64 rowCount = postEndRow - dataEnd + 1;
+        emit requestPreloadData(dataEnd, rowCount, m_requestGeneration);
+        m_pendingBack.startRow = dataEnd;
+        m_pendingBack.requestedAt = now;
+        qDebug() << "请求后置预加载数据: 起始行=" << dataEnd << ", 行数=" << rowCount;
         m_statusManager->startTiming(tr("预加载后方数据"));
-        qDebug() << "请求后置预加载数据: 起始行=" << (postStartRow) << ", 行数=" << rowCount;
     }
 }
 
@@ -808,9 +988,11 @@ void MainWindow::handleLargeScroll(qint64 targetPosition)
     qDebug() << "大范围滚动处理: 起始行=" << startRow + 1 << ", 行数=" << rowCount;
     
     // 3. 请求数据加载
-    emit requestRowsData(startRow + 1, rowCount); // +1是因为跳过表头
+    emit requestRowsData(startRow + 1, rowCount, nextRequestGeneration()); // +1是因为跳过表头
     m_statusManager->startTiming(tr("加载数据"));
-    m_preloadTimer->start(1000);     // 500ms 延迟
+    // 之前的预加载随旧的代数一起作废，收到可视区域的数据后重新安排
+    m_pendingFront = PendingPrefetch();
+    m_pendingBack = PendingPrefetch();
     // 4. 更新当前起始行
     m_currentStartRow = targetPosition;
 }
@@ -818,25 +1000,24 @@ void MainWindow::handleLargeScroll(qint64 targetPosition)
 // 小范围滚动处理
 void MainWindow::handleSmallScroll(qint64 targetPosition)
 {
-    // 小范围滚动时，调整TableModel中的可视窗口
-    qint64 relativePosition = targetPosition - m_lastScrollPosition;
+    // 小范围滚动时，调整TableModel中的可视窗口；按模型当前的位置计算偏移，裁剪后也不会错位
+    qint64 relativePosition = targetPosition + 1 - m_tableModel->getCurrentWindowStartRow();
     
     qDebug() << "小范围滚动处理: targetPosition=" << targetPosition 
              << ", relativePosition=" << relativePosition
              <<", visiableStart=" << m_tableModel->getVisiableStartRow()
-             <<", fulldatasize -1="<<m_tableModel->getFullDataSize()-1;
+             <<", fulldatasize="<<m_tableModel->getFullDataSize();
 
-    //if()上下方向移动预加载
-
-    if((m_tableModel->getVisiableStartRow() + relativePosition < 1) || (m_tableModel->getVisiableStartRow() + m_visibleRows + relativePosition > m_tableModel->getFullDataSize()-1))
+    if (!m_tableModel->containsRows(targetPosition + 1, m_visibleRows))
     {
-        //待处理为直接预加载
+        // 预加载没有跟上（或直接跳转到了远处）
         qDebug() << "小范围滚动超出范围，降级到大范围滚动处理";
         handleLargeScroll(targetPosition);
     }
     else
     {
         m_tableModel->adjustVisibleWindow(relativePosition);
+        schedulePrefetch();
     }
 }
 
@@ -893,24 +1074,40 @@ void MainWindow::PreloadedDataReceived(const struct CsvRowData &rowData, qint64
 {
     qDebug() << "接收到预加载数据: startRow=" << startRow << ", 数据行数=" << rowData.rows.size();
     
+    // 记录读取延迟，预加载器据此决定要提前多少行
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (startRow == m_pendingFront.startRow) {
+        m_prefetcher.recordLatency(now - m_pendingFront.requestedAt);
+        m_pendingFront = PendingPrefetch();
+    } else if (startRow == m_pendingBack.startRow) {
+        m_prefetcher.recordLatency(now - m_pendingBack.requestedAt);
+        m_pendingBack = PendingPrefetch();
+    }
+    if (rowData.rows.isEmpty()) {
+        return;
+    }
+    
     // 根据预加载数据的位置决定是向前还是向后整合数据
     qint64 currentDataStartRow = m_tableModel->getFullDataStartRow();
     qint64 preloadedDataEndRow = startRow + rowData.rows.size() - 1;
     qint64 currentDataEndRow = currentDataStartRow + m_tableModel->getFullDataSize() - 1;
     
-    if (preloadedDataEndRow < currentDataStartRow) {
+    // 只整合与已有数据相接的部分，重叠的行去掉；中间有空缺（窗口已移走）时丢弃
+    if (startRow < currentDataStartRow && preloadedDataEndRow >= currentDataStartRow - 1) {
         // 预加载的是前方数据
-        if (m_tableModel->canPrependData(startRow)) {
-            m_tableModel->prependPreloadedData(rowData.rows);
-            m_statusManager->endTiming(tr("预加载前方数据"));
-        }
-    } else if (startRow > currentDataEndRow) {
+        m_tableModel->prependPreloadedData(rowData.rows, 0, int(currentDataStartRow - startRow));
+        m_statusManager->endTiming(tr("预加载前方数据"));
+    } else if (preloadedDataEndRow > currentDataEndRow && startRow <= currentDataEndRow + 1) {
         // 预加载的是后方数据
-        if (m_tableModel->canAppendData(preloadedDataEndRow)) {
-            m_tableModel->appendPreloadedData(rowData.rows);
-            m_statusManager->endTiming(tr("预加载后方数据"));
-        }
+        const int skip = int(currentDataEndRow + 1 - startRow);
+        m_tableModel->appendPreloadedData(rowData.rows, skip, rowData.rows.size() - skip);
+        m_statusManager->endTiming(tr("预加载后方数据"));
+    } else {
+        return;
     }
+    
+    // 继续补充
+    m_prefetchDue = true;
 }
 
 
@@ -952,6 +1149,40 @@ void MainWindow::on_action_goto_row_triggered()
     }
 }
 
+void MainWindow::on_action_follow_toggled(bool checked)
+{
+    // 自动滚动只在跟踪模式下有意义
+    ui->action_auto_scroll->setEnabled(checked);
+    emit followModeChanged(checked);
+}
+
+void MainWindow::on_action_cache_budget_triggered()
+{
+    bool ok;
+    const int hotMb = QInputDialog::getInt(this, tr("行块缓存预算"),
+                                           tr("热层内存预算 (MB，0为不缓存):"),
+                                           int(m_blockCacheBudget / (1024 * 1024)), 0, 4096, 16, &ok);
+    if (!ok) {
+        return;
+    }
+    const int coldMb = QInputDialog::getInt(this, tr("行块缓存预算"),
+                                            tr("冷层内存预算 (MB，按压缩后计，0为不保留淘汰的块):"),
+                                            int(m_coldBlockCacheBudget / (1024 * 1024)), 0, 4096, 16, &ok);
+    if (!ok) {
+        return;
+    }
+    m_blockCacheBudget = qint64(hotMb) * 1024 * 1024;
+    m_coldBlockCacheBudget = qint64(coldMb) * 1024 * 1024;
+    applyBlockCacheBudgets();
+}
+
+void MainWindow::applyBlockCacheBudgets()
+{
+    emit blockCacheBudgetsChanged(m_blockCacheBudget, m_coldBlockCacheBudget);
+    // 数据窗口中的行引用热层中的行块，窗口只占热层预算的一半，预加载的块在显示前不会被淘汰
+    m_prefetcher.setMemoryBudget(m_blockCacheBudget / 2);
+}
+
 void MainWindow::gotoRow(qint64 row)
 {
     // 行号从1开始，转换为从0开始的索引并考虑表头
@@ -965,9 +1196,13 @@ void MainWindow::gotoRow(qint64 row)
     
     PRINT_DEBUG(QString("跳转到行: %1 (0基索引: %2)").arg(row).arg(targetRow));
     
+    // 跳转前的滚动速度与目标位置无关，预加载从两侧各一屏重新开始
+    m_prefetcher.resetVelocity();
+    
     // 设置滚动条位置为目标行
-    m_internalScrollBarChange = true; // 防止触发重新加载
+    m_internalScrollBarChange = true; // 由下面的handleLargeScroll加载，滚动条的变化不再触发读取
     ui->verticalScrollBar->setValue(static_cast<int>(targetRow));
+    m_internalScrollBarChange = false;
     
     // 直接处理大范围滚动以加载目标行数据
     handleLargeScroll(targetRow);
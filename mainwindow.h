@@ -19,6 +19,7 @@
 #include <QListWidget>
 #include <QTabWidget>
 #include "statusmanager.h"
+#include "prefetcher.h"
 
 // 调试宏定义，可通过注释掉这行来关闭所有调试信息
 #define DEBUG_PRINT true
@@ -48,22 +49,30 @@ public:
 
 signals:
     void initCsvReader(const QString &fileName);
-    void requestRowsData(qint64 startRow, qint64 rowCount); // 添加请求数据行的信号
-    void requestPreloadData(qint64 startRow, qint64 rowCount); // 添加请求预加载数据的信号
+    void requestRowsData(qint64 startRow, qint64 rowCount, quint64 generation); // 请求可视窗口的数据行，generation为请求代数
+    void requestPreloadData(qint64 startRow, qint64 rowCount, quint64 generation); // 请求预加载数据，与所属的可视窗口请求同一代
+    void followModeChanged(bool enabled); // 开启/关闭跟踪文件追加
+    void blockCacheBudgetsChanged(qint64 hotBytes, qint64 coldBytes); // 行块缓存两层的内存预算改变
 
 private slots:
     void on_action_open_triggered();
     void on_action_show_select_triggered();
     void on_action_goto_row_triggered(); // 添加跳转到行的槽函数
+    void on_action_follow_toggled(bool checked); // 跟踪模式开关
+    void on_action_cache_budget_triggered(); // 设置行块缓存的内存预算
     void on_pushButton_all_clicked();
     void on_pushButton_clear_clicked();
     void on_pushButton_filter_clicked();
     void on_lineEdit_clowmn_name_textChanged(const QString &text);
     void onInitializationDataReceived(const QVector<QString> &headers);
+    void onIndexProgress(qint64 totalRows, bool finished); // 后台索引进度，实时扩展滚动条范围
+    void onRowCountEstimated(qint64 estimatedRows, double relativeError); // 索引完成前按估计的总行数设置滚动条范围
+    void onFileAppended(qint64 totalRows); // 跟踪模式下文件追加了新行
     void onRowsDataReceived(const struct CsvRowData &rowData, qint64 startRow); // 修改参数类型以匹配信号
+    void onRowDataAvailable(); // 读取结果通道有新结果，安排在下一帧取出
+    void drainRowData(); // 取出通道中的全部结果，在一次模型批量更新中应用
     void onVerticalScrollBarValueChanged(int value); // 添加滚动条值变化槽函数
     void onDelayedLoad(); // 添加延迟加载槽函数
-    void onPreloadTimeout(); // 添加预加载超时槽函数
     void resetScrollBarColor(); // 添加重置滚动条颜色槽函数
     void onBookmarkItemDoubleClicked(QListWidgetItem *item);
     void onAddBookmarkTriggered();
@@ -89,12 +98,30 @@ private:
     QThread *m_workerThread;
     QTimer *m_delayedLoadTimer; // 延迟加载定时器
     QTimer *m_scrollBarResetTimer; // 滚动条颜色重置定时器
-    QTimer *m_preloadTimer; // 预加载定时器
-    qint64 m_totalRows; // 文件总行数
+    QTimer *m_frameTimer; // 每帧最多取一次读取结果，同一帧内到达的结果一起应用
+    qint64 m_lastDrainAt = 0; // 上次取读取结果的时刻（毫秒）
+    bool m_prefetchDue = false; // 批量更新结束后补充预加载
+    static constexpr int FrameIntervalMs = 16; // 约60帧每秒
+    qint64 m_totalRows; // 文件总行数（索引完成前可能是估计值）
+    qint64 m_indexedRows = 0; // 已建立索引、可以读取的行数
+    bool m_rowCountExact = true; // m_totalRows是否为精确值
+    double m_rowCountError = 0.0; // 估计总行数的相对误差
     qint64 m_visibleRows; // 可视行数
     qint64 m_currentStartRow; // 当前显示的数据起始行
+    quint64 m_requestGeneration = 0; // 最近一次可视窗口请求的代数，之前的请求（含其预加载）已作废
+    QVector<int> m_projection; // 读取请求带上的列投影（升序的原始列号），为空时读取全部列
+    Prefetcher m_prefetcher; // 按滚动速度和读取延迟决定预加载的范围
+    qint64 m_blockCacheBudget = 64LL * 1024 * 1024;     // 行块缓存热层的内存预算，经blockCacheBudgetsChanged交给读取线程
+    qint64 m_coldBlockCacheBudget = 64LL * 1024 * 1024; // 行块缓存冷层的内存预算（压缩后）
+    // 正在读取的一次预加载，startRow为-1表示没有
+    struct PendingPrefetch {
+        qint64 startRow = -1;
+        qint64 requestedAt = 0; // 请求时刻（毫秒），用于测量读取延迟
+    };
+    PendingPrefetch m_pendingFront; // 可视区域之前的预加载
+    PendingPrefetch m_pendingBack;  // 可视区域之后的预加载
     qint64 m_lastScrollPosition; // 上次滚动位置
-    bool m_internalScrollBarChange; // 防止滚动条信号循环调用
+    bool m_internalScrollBarChange; // 为true时滚动条的变化由代码设置且调用方自行加载，valueChanged不再发出读取
     int m_defaultRowHeight; // 默认行高
     QMap<QString, qint64> m_bookmarks; // 书签映射，键为书签名称，值为行号
     QMenu *m_contextMenu; // 右键菜单
@@ -118,11 +145,14 @@ private:
     ScrollType detectScrollType(qint64 oldPosition, qint64 newPosition); // 滚动类型识别
     void handleLargeScroll(qint64 targetPosition); // 大范围滚动处理
     void handleSmallScroll(qint64 targetPosition); // 小范围滚动处理
-    void preloadData(qint64 centerRow); // 预加载数据
+    void schedulePrefetch(); // 按预加载器的计划补充可视区域前后的数据
+    void applyBlockCacheBudgets(); // 把行块缓存预算交给读取线程，并按热层预算设置数据窗口的预算
+    quint64 nextRequestGeneration(); // 开始新一代可视窗口请求，并通知读取线程丢弃之前的请求
     void generateColumnCheckboxes(const QVector<QString> &headers);
     void toggleSelectAll(bool select);
     void filterCheckboxes(const QString &text);
     void updateScrollBarRange(); // 更新滚动条范围
+    void updateIndexingStatus(); // 在状态栏显示估计总行数和索引进度
     void updateVisibleRows(); // 更新可视行数
     int getUniformRowHeight() const; // 获取统一行高
     void PreloadedDataReceived(const struct CsvRowData &rowData, qint64 startRow); // 添加预加载数据函数
@@ -0,0 +1,153 @@
+// 32位系统上也使用64位的off_t，pread可以访问超过2GB的偏移（必须在所有系统头文件之前定义）
+#if !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "positionalfile.h"
+#include <QFile>
+#include <QDir>
+#include <QDebug>
+
+#if defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+PositionalFile::PositionalFile()
+#if defined(Q_OS_WIN)
+    : m_handle(INVALID_HANDLE_VALUE)
+#else
+    : m_fd(-1)
+#endif
+{
+}
+
+PositionalFile::~PositionalFile()
+{
+    close();
+}
+
+bool PositionalFile::open(const QString &fileName)
+{
+    close();
+#if defined(Q_OS_WIN)
+    const QString nativeName = QDir::toNativeSeparators(fileName);
+    m_handle = CreateFileW(reinterpret_cast<const wchar_t *>(nativeName.utf16()), GENERIC_READ,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (m_handle == INVALID_HANDLE_VALUE) {
+        qDebug() << "Cannot open file:" << fileName << "error:" << GetLastError();
+        return false;
+    }
+#else
+    int flags = O_RDONLY;
+#if defined(O_CLOEXEC)
+    flags |= O_CLOEXEC;
+#endif
+    do {
+        m_fd = ::open(QFile::encodeName(fileName).constData(), flags);
+    } while (m_fd < 0 && errno == EINTR);
+    if (m_fd < 0) {
+        qDebug() << "Cannot open file:" << fileName << "errno:" << errno;
+        return false;
+    }
+#endif
+    m_fileName = fileName;
+    return true;
+}
+
+void PositionalFile::close()
+{
+#if defined(Q_OS_WIN)
+    if (m_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_fileName.clear();
+}
+
+bool PositionalFile::isOpen() const
+{
+#if defined(Q_OS_WIN)
+    return m_handle != INVALID_HANDLE_VALUE;
+#else
+    return m_fd >= 0;
+#endif
+}
+
+QString PositionalFile::fileName() const
+{
+    return m_fileName;
+}
+
+qint64 PositionalFile::size() const
+{
+    if (!isOpen()) {
+        return -1;
+    }
+#if defined(Q_OS_WIN)
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_handle, &fileSize)) {
+        return -1;
+    }
+    return fileSize.QuadPart;
+#else
+    struct stat info;
+    if (::fstat(m_fd, &info) != 0) {
+        return -1;
+    }
+    return info.st_size;
+#endif
+}
+
+qint64 PositionalFile::read(qint64 offset, char *buffer, qint64 size) const
+{
+    if (!isOpen() || offset < 0 || size < 0) {
+        return -1;
+    }
+    // 一次调用通常就能读满，只有被信号打断或单次读取上限较小时才循环
+    qint64 total = 0;
+    while (total < size) {
+#if defined(Q_OS_WIN)
+        OVERLAPPED overlapped = {};
+        const quint64 position = static_cast<quint64>(offset + total);
+        overlapped.Offset = static_cast<DWORD>(position & 0xFFFFFFFFu);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        const DWORD request = static_cast<DWORD>(qMin<qint64>(size - total, 1 << 30));
+        DWORD bytesRead = 0;
+        if (!ReadFile(m_handle, buffer + total, request, &bytesRead, &overlapped)) {
+            if (GetLastError() == ERROR_HANDLE_EOF) {
+                break;
+            }
+            return total > 0 ? total : -1;
+        }
+#else
+        const ssize_t bytesRead = ::pread(m_fd, buffer + total, static_cast<size_t>(size - total),
+                                          static_cast<off_t>(offset + total));
+        if (bytesRead < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return total > 0 ? total : -1;
+        }
+#endif
+        if (bytesRead == 0) {
+            break; // 文件末尾
+        }
+        total += bytesRead;
+    }
+    return total;
+}
@@ -0,0 +1,53 @@
+#ifndef POSITIONALFILE_H
+#define POSITIONALFILE_H
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @class PositionalFile
+ * @brief 只读的文件句柄，按指定偏移读取，不使用也不改变共享的读写位置
+ *
+ * 文件打开后在整个查看期间保持打开，每次读取只是一次pread（Windows上为带OVERLAPPED偏移的ReadFile），
+ * 不再有打开、定位、关闭的系统调用。读取不依赖文件位置，多个线程可以同时读取同一个句柄。
+ * Windows上以允许写入、删除的共享方式打开，不妨碍写日志的程序追加或轮转文件。
+ */
+class PositionalFile
+{
+public:
+    PositionalFile();
+    ~PositionalFile();
+
+    /**
+     * @brief 打开文件，已打开的文件先关闭
+     * @return 打开失败返回false
+     */
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const;
+    QString fileName() const;
+
+    /**
+     * @brief 当前文件大小（按已打开的句柄查询，文件被替换后仍是旧文件的大小）
+     * @return 失败返回-1
+     */
+    qint64 size() const;
+
+    /**
+     * @brief 从offset处读取最多size字节
+     * @return 实际读取的字节数，到达文件末尾时小于size，出错返回-1
+     */
+    qint64 read(qint64 offset, char *buffer, qint64 size) const;
+
+private:
+    Q_DISABLE_COPY(PositionalFile)
+
+    QString m_fileName;
+#if defined(Q_OS_WIN)
+    void *m_handle; // HANDLE，避免在头文件中引入windows.h
+#else
+    int m_fd;
+#endif
+};
+
+#endif // POSITIONALFILE_H
@@ -0,0 +1,101 @@
+#include "prefetcher.h"
+#include <QtMath>
+
+Prefetcher::Prefetcher()
+    : m_visibleRows(1)
+    , m_memoryBudget(32LL * 1024 * 1024) // 默认32MB
+    , m_velocity(0.0)
+    , m_latencyMs(DefaultLatencyMs)
+    , m_bytesPerRow(0.0)
+    , m_lastPosition(0)
+    , m_lastTimestamp(-1)
+{
+}
+
+void Prefetcher::recordScroll(qint64 position, qint64 timestampMs)
+{
+    if (m_lastTimestamp < 0 || timestampMs - m_lastTimestamp > IdleMs) {
+        // 停顿之后重新开始估计，不沿用上一次滚动的速度
+        m_velocity = 0.0;
+    } else {
+        const qint64 elapsed = qMax<qint64>(1, timestampMs - m_lastTimestamp);
+        const double sample = double(position - m_lastPosition) * 1000.0 / elapsed;
+        m_velocity = m_velocity == 0.0 ? sample : m_velocity + Smoothing * (sample - m_velocity);
+    }
+    m_lastPosition = position;
+    m_lastTimestamp = timestampMs;
+}
+
+void Prefetcher::recordLatency(qint64 latencyMs)
+{
+    m_latencyMs += Smoothing * (qMax<qint64>(0, latencyMs) - m_latencyMs);
+}
+
+void Prefetcher::recordBlock(qint64 rows, qint64 bytes)
+{
+    if (rows <= 0 || bytes <= 0) {
+        return;
+    }
+    const double sample = double(bytes) / rows;
+    m_bytesPerRow = m_bytesPerRow == 0.0 ? sample : m_bytesPerRow + Smoothing * (sample - m_bytesPerRow);
+}
+
+void Prefetcher::setVisibleRows(qint64 visibleRows)
+{
+    m_visibleRows = qMax<qint64>(1, visibleRows);
+}
+
+void Prefetcher::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = qMax<qint64>(0, bytes);
+}
+
+qint64 Prefetcher::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+qint64 Prefetcher::maxWindowRows() const
+{
+    // 至少保留原来的三屏；每行大小未知时只按三屏计
+    const qint64 minimum = 3 * m_visibleRows;
+    if (m_bytesPerRow <= 0.0) {
+        return minimum;
+    }
+    return qMax(minimum, qint64(m_memoryBudget / m_bytesPerRow));
+}
+
+Prefetcher::Plan Prefetcher::plan(qint64 nowMs) const
+{
+    Plan result;
+    result.aheadRows = m_visibleRows;
+    result.behindRows = m_visibleRows;
+    const bool moving = m_lastTimestamp >= 0 && nowMs - m_lastTimestamp <= IdleMs && m_velocity != 0.0;
+    if (!moving) {
+        return result;
+    }
+
+    result.direction = m_velocity > 0 ? 1 : -1;
+    // 读取延迟内会滚过的行数，再加一屏余量
+    const double lookaheadMs = m_latencyMs * SafetyFactor;
+    const qint64 travelRows = qCeil(qAbs(m_velocity) * lookaheadMs / 1000.0);
+    const qint64 available = maxWindowRows() - m_visibleRows - result.behindRows;
+    result.aheadRows = qBound(m_visibleRows, travelRows + m_visibleRows, qMax(m_visibleRows, available));
+    return result;
+}
+
+double Prefetcher::velocity() const
+{
+    return m_velocity;
+}
+
+double Prefetcher::latencyMs() const
+{
+    return m_latencyMs;
+}
+
+void Prefetcher::resetVelocity()
+{
+    m_velocity = 0.0;
+    m_lastTimestamp = -1;
+}
@@ -0,0 +1,86 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <QtGlobal>
+
+/**
+ * @class Prefetcher
+ * @brief 按滚动速度和读取延迟决定数据窗口在可视区域前后各保留多少行
+ *
+ * 滚动速度（行/秒，带方向）和预加载的读取延迟都取指数滑动平均。沿滚动方向需要保留的行数
+ * 为"读取延迟内会滚过的行数"加一屏余量，反方向只保留一屏以便回滚；停止滚动后两侧各一屏。
+ * 窗口总行数受内存预算限制（由MainWindow按行块缓存的预算设置），每行占用的字节数由已收到的数据块估计。
+ * 只做计算，不发出请求，由MainWindow决定何时请求和裁剪。
+ */
+class Prefetcher
+{
+public:
+    Prefetcher();
+
+    // 沿滚动方向和反方向各需要保留的行数（不含可视区域）
+    struct Plan {
+        qint64 aheadRows = 0;
+        qint64 behindRows = 0;
+        int direction = 0; // 1向下，-1向上，0静止
+    };
+
+    /**
+     * @brief 记录一次滚动位置，更新速度估计
+     * @param position 滚动条位置（行）
+     * @param timestampMs 时间戳（毫秒）
+     */
+    void recordScroll(qint64 position, qint64 timestampMs);
+
+    /**
+     * @brief 记录一次预加载从请求到收到数据的延迟
+     */
+    void recordLatency(qint64 latencyMs);
+
+    /**
+     * @brief 记录收到的数据块大小，用于估计每行占用的内存
+     */
+    void recordBlock(qint64 rows, qint64 bytes);
+
+    void setVisibleRows(qint64 visibleRows);
+
+    /**
+     * @brief 数据窗口的内存预算（字节），为0时只保留三屏
+     */
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+
+    /**
+     * @brief 按当前速度、延迟和内存预算计算前后需要保留的行数
+     * @param nowMs 当前时间戳，距上次滚动超过IdleMs视为静止
+     */
+    Plan plan(qint64 nowMs) const;
+
+    /**
+     * @brief 数据窗口最多保留的行数（含可视区域）
+     */
+    qint64 maxWindowRows() const;
+
+    double velocity() const;  // 行/秒，正数向下
+    double latencyMs() const; // 预加载延迟的滑动平均
+
+    /**
+     * @brief 清空速度估计（打开新文件、跳转或改变筛选列时），之前的滚动与新位置无关
+     */
+    void resetVelocity();
+
+private:
+    static constexpr double Smoothing = 0.3;       // 指数滑动平均中新样本的权重
+    static constexpr qint64 IdleMs = 300;          // 超过该时间没有滚动视为静止
+    static constexpr double SafetyFactor = 2.0;    // 按两倍平均延迟预留，吸收延迟抖动
+    static constexpr qint64 DefaultLatencyMs = 50; // 尚无测量时假设的延迟
+
+    qint64 m_visibleRows;
+    qint64 m_memoryBudget; // 数据窗口的内存预算（字节）
+    double m_velocity;
+    double m_latencyMs;
+    double m_bytesPerRow;
+    qint64 m_lastPosition;
+    qint64 m_lastTimestamp; // 为-1表示尚无滚动记录
+};
+
+#endif // PREFETCHER_H
@@ -0,0 +1,50 @@
+#ifndef QUOTEMASK_H
+#define QUOTEMASK_H
+
+#include "cpufeatures.h"
+
+#if defined(CSV_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief 由64字节块的引号位掩码计算引号区域掩码
+ *
+ * 前缀异或的结果第i位为1，表示第i个字节处于引号内（第i位及之前的引号个数为奇数）。
+ * 行索引扫描和字段切分都用它一次判断整块中的换行符/分隔符是否在引号内，不逐个处理引号。
+ */
+namespace QuoteMask {
+
+// 用移位实现，需要log2(64)=6步
+inline quint64 prefixXorShift(quint64 mask)
+{
+    mask ^= mask << 1;
+    mask ^= mask << 2;
+    mask ^= mask << 4;
+    mask ^= mask << 8;
+    mask ^= mask << 16;
+    mask ^= mask << 32;
+    return mask;
+}
+
+#if defined(CSV_SIMD_X86)
+// 同样的前缀异或，用一次与全1的无进位乘法完成
+CSV_TARGET("pclmul")
+inline quint64 prefixXorClmul(quint64 mask)
+{
+    const __m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<qint64>(mask)), _mm_set1_epi8(-1), 0);
+    quint64 result;
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(&result), product); // 32位平台没有_mm_cvtsi128_si64
+    return result;
+}
+#endif
+
+// 块起点处于引号内时整个区域掩码取反
+inline quint64 carry(bool inQuotes)
+{
+    return inQuotes ? ~quint64(0) : quint64(0);
+}
+
+}
+
+#endif // QUOTEMASK_H
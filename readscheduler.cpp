@@ -0,0 +1,132 @@
+#include "readscheduler.h"
+#include <QMutexLocker>
+#include <QThread>
+
+ReadScheduler::ReadScheduler()
+{
+    m_clock.start();
+}
+
+void ReadScheduler::submit(ReadRequest request)
+{
+    const int index = static_cast<int>(request.priority);
+    QMutexLocker locker(&m_mutex);
+    request.submittedAt = m_clock.elapsed();
+    m_queues[index].enqueue(request);
+    m_stats[index].depth = m_queues[index].size();
+    m_waiting[index].fetchAndAddOrdered(1);
+}
+
+bool ReadScheduler::takeNext(ReadRequest *request)
+{
+    QMutexLocker locker(&m_mutex);
+    for (int index = 0; index < PriorityCount; ++index) {
+        if (m_queues[index].isEmpty()) {
+            continue;
+        }
+        *request = m_queues[index].dequeue();
+        m_stats[index].depth = m_queues[index].size();
+        m_waiting[index].fetchAndAddOrdered(-1);
+        recordWait(index, m_clock.elapsed() - request->submittedAt);
+        return true;
+    }
+    return false;
+}
+
+void ReadScheduler::requeue(const ReadRequest &request)
+{
+    const int index = static_cast<int>(request.priority);
+    QMutexLocker locker(&m_mutex);
+    m_queues[index].prepend(request);
+    m_stats[index].depth = m_queues[index].size();
+    m_waiting[index].fetchAndAddOrdered(1);
+}
+
+bool ReadScheduler::hasWaitingAbove(ReadPriority priority) const
+{
+    for (int index = 0; index < static_cast<int>(priority); ++index) {
+        if (m_waiting[index].loadAcquire() > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ReadScheduler::beginRequest(ReadPriority priority)
+{
+    m_running[static_cast<int>(priority)].fetchAndAddOrdered(1);
+}
+
+void ReadScheduler::endRequest(ReadPriority priority)
+{
+    m_running[static_cast<int>(priority)].fetchAndAddOrdered(-1);
+}
+
+qint64 ReadScheduler::yieldToForeground(const QAtomicInt &cancel)
+{
+    const int background = static_cast<int>(ReadPriority::Background);
+    auto foregroundBusy = [this, background]() {
+        for (int index = 0; index < background; ++index) {
+            if (m_waiting[index].loadAcquire() > 0 || m_running[index].loadAcquire() > 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+    if (!foregroundBusy()) {
+        return 0;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stats[background].depth++;
+    }
+    while (foregroundBusy() && !cancel.loadRelaxed()) {
+        QThread::msleep(YieldSleepMs);
+    }
+    const qint64 waited = timer.elapsed();
+    QMutexLocker locker(&m_mutex);
+    m_stats[background].depth--;
+    recordWait(background, waited);
+    return waited;
+}
+
+void ReadScheduler::clear()
+{
+    // 在后台工作停止后调用，后台的让出计数此时为0，可以一并重置
+    QMutexLocker locker(&m_mutex);
+    for (int index = 0; index < PriorityCount; ++index) {
+        m_waiting[index].fetchAndAddOrdered(-m_queues[index].size());
+        m_queues[index].clear();
+        m_stats[index] = ReadQueueStats();
+    }
+}
+
+ReadQueueStats ReadScheduler::stats(ReadPriority priority) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats[static_cast<int>(priority)];
+}
+
+QString ReadScheduler::priorityName(ReadPriority priority)
+{
+    switch (priority) {
+    case ReadPriority::Visible:
+        return QStringLiteral("可视");
+    case ReadPriority::Prefetch:
+        return QStringLiteral("预加载");
+    case ReadPriority::Background:
+        return QStringLiteral("后台");
+    }
+    return QString();
+}
+
+void ReadScheduler::recordWait(int index, qint64 waitMs)
+{
+    ReadQueueStats &stats = m_stats[index];
+    stats.lastWaitMs = waitMs;
+    stats.maxWaitMs = qMax(stats.maxWaitMs, waitMs);
+    stats.served++;
+}
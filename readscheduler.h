@@ -0,0 +1,111 @@
+#ifndef READSCHEDULER_H
+#define READSCHEDULER_H
+
+#include <QtGlobal>
+#include <QString>
+#include <QQueue>
+#include <QVector>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+// 读取请求的优先级，数值越小越优先
+enum class ReadPriority {
+    Visible,    // 可视窗口的数据行
+    Prefetch,   // 可视窗口附近的预加载
+    Background  // 后台索引等不影响当前显示的工作
+};
+
+struct ReadRequest {
+    qint64 startRow = 0;
+    qint64 rowCount = 0;
+    quint64 generation = 0; // 所属可视窗口请求的代数
+    ReadPriority priority = ReadPriority::Visible;
+    QVector<int> projection; // 读取时只保存的原始列号（升序），为空时保存全部列；随请求提交，执行时才生效
+    qint64 submittedAt = 0; // 提交时刻（调度器时钟，毫秒）
+};
+
+// 一个优先级的队列统计
+struct ReadQueueStats {
+    int depth = 0;         // 排队中的请求数（后台为正在让出的工作数）
+    qint64 lastWaitMs = 0; // 最近一次从提交到开始执行的等待时间
+    qint64 maxWaitMs = 0;  // 打开文件以来的最长等待时间
+    qint64 served = 0;     // 已开始执行的请求数
+};
+
+/**
+ * @class ReadScheduler
+ * @brief 工作线程的读取调度器，按优先级而不是到达顺序执行读取请求
+ *
+ * 每个优先级一个先进先出队列，取请求时总是先取最高优先级的队列。界面线程直接提交请求（加锁），
+ * 不经过工作线程的事件队列，所以执行中的低优先级读取可以通过hasWaitingAbove及时发现
+ * 更高优先级的请求并让出；被抢占的请求放回所在队列的最前面。后台工作不经过队列，
+ * 在每个阶段之间调用yieldToForeground，等前台读取结束后再继续。
+ */
+class ReadScheduler
+{
+public:
+    static constexpr int PriorityCount = 3;
+
+    ReadScheduler();
+
+    /**
+     * @brief 提交请求（线程安全），记录提交时刻
+     */
+    void submit(ReadRequest request);
+
+    /**
+     * @brief 取出优先级最高的请求（线程安全），并记录它的等待时间
+     * @return 队列为空时返回false
+     */
+    bool takeNext(ReadRequest *request);
+
+    /**
+     * @brief 被抢占的请求放回所在队列的最前面，保持原来的提交时刻
+     */
+    void requeue(const ReadRequest &request);
+
+    /**
+     * @brief 是否有比priority更优先的请求正在排队（无锁，可在读取循环中频繁调用）
+     */
+    bool hasWaitingAbove(ReadPriority priority) const;
+
+    /**
+     * @brief 标记一个请求开始/结束执行（工作线程调用）
+     */
+    void beginRequest(ReadPriority priority);
+    void endRequest(ReadPriority priority);
+
+    /**
+     * @brief 后台工作在阶段之间调用：有前台请求排队或执行时等待，直到前台空闲或被取消
+     * @param cancel 置1时立即返回
+     * @return 等待的毫秒数
+     */
+    qint64 yieldToForeground(const QAtomicInt &cancel);
+
+    /**
+     * @brief 清空所有队列和统计（打开新文件、后台工作已停止时）
+     */
+    void clear();
+
+    ReadQueueStats stats(ReadPriority priority) const;
+
+    /**
+     * @brief 优先级的显示名称
+     */
+    static QString priorityName(ReadPriority priority);
+
+private:
+    static constexpr int YieldSleepMs = 2; // 后台让出时每次检查的间隔
+
+    mutable QMutex m_mutex; // 保护队列和统计
+    QQueue<ReadRequest> m_queues[PriorityCount];
+    ReadQueueStats m_stats[PriorityCount];
+    QAtomicInt m_waiting[PriorityCount]; // 各优先级排队中的请求数，供无锁检查
+    QAtomicInt m_running[PriorityCount]; // 各优先级执行中的请求数
+    QElapsedTimer m_clock;
+
+    void recordWait(int index, qint64 waitMs); // 调用时已加锁
+};
+
+#endif // READSCHEDULER_H
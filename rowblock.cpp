@@ -0,0 +1,264 @@
+#include "rowblock.h"
+#include "csvreader.h"
+#include "textdecoder.h"
+#include <cstring>
+
+RowBlock::RowBlock()
+    : m_rowDataStarts(1, 0)
+    , m_encoding(Encoding::UTF8)
+{
+}
+
+void RowBlock::setEncoding(Encoding encoding)
+{
+    m_encoding = encoding;
+}
+
+Encoding RowBlock::encoding() const
+{
+    return m_encoding;
+}
+
+void RowBlock::setColumns(const QVector<int> &columns)
+{
+    m_columns = columns;
+    m_columnSlots.clear();
+    if (!m_columns.isEmpty()) {
+        m_columnSlots.fill(-1, m_columns.last() + 1);
+        for (int i = 0; i < m_columns.size(); ++i) {
+            m_columnSlots[m_columns.at(i)] = i;
+        }
+    }
+    // 在追加记录前调用，已有的列数组都是空的，先全部放回备用列表，投影时再按投影的列数取出
+    while (!m_cells.isEmpty()) {
+        m_spareColumns.append(m_cells.takeLast());
+    }
+    if (!m_columns.isEmpty()) {
+        ensureColumns(m_columns.size());
+    }
+}
+
+const QVector<int> &RowBlock::columns() const
+{
+    return m_columns;
+}
+
+void RowBlock::ensureColumns(int count)
+{
+    const Cell missing = {MissingCell, MissingCell};
+    while (m_cells.size() < count) {
+        // 优先复用clear时留下的列数组，保留其容量
+        QVector<Cell> column = m_spareColumns.isEmpty() ? QVector<Cell>() : m_spareColumns.takeLast();
+        column.fill(missing, rowCount());
+        m_cells.append(column);
+    }
+}
+
+void RowBlock::appendRecord(const char *data, int size, char delimiter, QVector<FieldSpan> &spans)
+{
+    const CodeUnit unit = TextDecoder::codeUnitOf(m_encoding);
+    CsvTokenizer::trim(data, size, unit);
+    CsvTokenizer::tokenize(data, size, delimiter, spans, unit);
+
+    const Cell missing = {MissingCell, MissingCell};
+    auto cellOf = [](int offset, const FieldSpan &field) {
+        return Cell{quint32(offset), quint32(field.length) | (field.needsUnescape ? UnescapeFlag : 0u)};
+    };
+    if (m_columns.isEmpty()) {
+        // 整条记录复制到字节区，字段位置平移到字节区中的位置
+        const int base = m_data.size();
+        m_data.append(data, size);
+        ensureColumns(spans.size());
+        for (int column = 0; column < spans.size(); ++column) {
+            const FieldSpan &field = spans.at(column);
+            m_cells[column].append(cellOf(base + field.offset, field));
+        }
+        for (int column = spans.size(); column < m_cells.size(); ++column) {
+            m_cells[column].append(missing);
+        }
+    } else {
+        // 只复制投影中的字段
+        for (int slot = 0; slot < m_columns.size(); ++slot) {
+            const int column = m_columns.at(slot);
+            if (column >= spans.size()) {
+                m_cells[slot].append(missing);
+                continue;
+            }
+            const FieldSpan &field = spans.at(column);
+            const int offset = m_data.size();
+            m_data.append(data + field.offset, field.length);
+            m_cells[slot].append(cellOf(offset, field));
+        }
+    }
+    m_rowDataStarts.append(m_data.size());
+}
+
+void RowBlock::clear()
+{
+    // reserve使缩为空时保留缓冲区（Qt5中未预留容量的QByteArray缩为空时会释放）
+    m_data.reserve(m_data.capacity());
+    m_data.resize(0);
+    // 列数归零，清空后的列数组移入备用列表，下一个文件列数较少时不会多出全为MissingCell的列
+    while (!m_cells.isEmpty()) {
+        QVector<Cell> column = m_cells.takeLast();
+        column.resize(0);
+        m_spareColumns.append(column);
+    }
+    m_rowDataStarts.resize(1);
+    m_rowDataStarts[0] = 0;
+    // 投影属于上一次读取，块再次取出时由读取方重新设置
+    m_columns.clear();
+    m_columnSlots.clear();
+}
+
+int RowBlock::rowCount() const
+{
+    return m_rowDataStarts.size() - 1;
+}
+
+bool RowBlock::isEmpty() const
+{
+    return rowCount() == 0;
+}
+
+int RowBlock::columnSlot(int column) const
+{
+    if (m_columns.isEmpty()) {
+        return column < m_cells.size() ? column : -1;
+    }
+    return column < m_columnSlots.size() ? m_columnSlots.at(column) : -1;
+}
+
+bool RowBlock::hasField(int row, int column) const
+{
+    if (row < 0 || row >= rowCount() || column < 0) {
+        return false;
+    }
+    const int slot = columnSlot(column);
+    return slot >= 0 && m_cells.at(slot).at(row).offset != MissingCell;
+}
+
+QString RowBlock::field(int row, int column, TextDecoder &decoder) const
+{
+    if (!hasField(row, column)) {
+        return QString();
+    }
+    const Cell cell = m_cells.at(columnSlot(column)).at(row);
+    const int length = int(cell.length & ~UnescapeFlag);
+    if (cell.length & UnescapeFlag) {
+        FieldSpan field;
+        field.offset = int(cell.offset);
+        field.length = length;
+        field.needsUnescape = true;
+        const QByteArray unescaped = CsvTokenizer::unescape(m_data.constData(), field, decoder.codeUnit());
+        return decoder.decode(unescaped.constData(), unescaped.size());
+    }
+    return decoder.decode(m_data.constData() + cell.offset, length);
+}
+
+qint64 RowBlock::memoryUsage() const
+{
+    qint64 cells = 0;
+    for (const QVector<Cell> &column : m_cells) {
+        cells += column.capacity() * qint64(sizeof(Cell));
+    }
+    for (const QVector<Cell> &column : m_spareColumns) {
+        cells += column.capacity() * qint64(sizeof(Cell));
+    }
+    return m_data.capacity() + cells
+           + (m_cells.capacity() + m_spareColumns.capacity()) * qint64(sizeof(QVector<Cell>))
+           + (m_rowDataStarts.capacity() + m_columnSlots.capacity()) * qint64(sizeof(int));
+}
+
+namespace {
+
+// toBytes的头部，其后依次为列投影、原始字节、各列的单元格位置、每行字节起始
+struct BlockHeader {
+    qint32 encoding;
+    qint32 columnCount;
+    qint32 dataSize;
+    qint32 slotCount;
+    qint32 rowCount;
+};
+
+template <typename T>
+void appendArray(QByteArray &out, const QVector<T> &values)
+{
+    out.append(reinterpret_cast<const char *>(values.constData()), values.size() * int(sizeof(T)));
+}
+
+template <typename T>
+bool readArray(const char *&p, const char *end, int count, QVector<T> &values)
+{
+    const qint64 bytes = qint64(count) * qint64(sizeof(T));
+    if (count < 0 || end - p < bytes) {
+        return false;
+    }
+    values.resize(count);
+    memcpy(values.data(), p, size_t(bytes));
+    p += bytes;
+    return true;
+}
+
+}
+
+QByteArray RowBlock::toBytes() const
+{
+    BlockHeader header;
+    header.encoding = static_cast<qint32>(m_encoding);
+    header.columnCount = m_columns.size();
+    header.dataSize = m_data.size();
+    header.slotCount = m_cells.size();
+    header.rowCount = rowCount();
+
+    QByteArray out;
+    out.reserve(int(sizeof(header)) + m_data.size() + m_cells.size() * rowCount() * int(sizeof(Cell))
+                + (m_columns.size() + m_rowDataStarts.size()) * int(sizeof(int)));
+    out.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    appendArray(out, m_columns);
+    out.append(m_data);
+    for (const QVector<Cell> &column : m_cells) {
+        appendArray(out, column);
+    }
+    appendArray(out, m_rowDataStarts);
+    return out;
+}
+
+bool RowBlock::restore(const QByteArray &bytes)
+{
+    clear();
+    BlockHeader header;
+    if (bytes.size() < int(sizeof(header))) {
+        return false;
+    }
+    memcpy(&header, bytes.constData(), sizeof(header));
+    const char *p = bytes.constData() + sizeof(header);
+    const char *end = bytes.constData() + bytes.size();
+    if (header.dataSize < 0 || header.rowCount < 0 || header.slotCount < 0 || end - p < header.dataSize) {
+        return false;
+    }
+
+    m_encoding = static_cast<Encoding>(header.encoding);
+    QVector<int> columns;
+    if (!readArray(p, end, header.columnCount, columns)) {
+        return false;
+    }
+    setColumns(columns);
+    if (end - p < header.dataSize) {
+        return false;
+    }
+    // 字节区和各列数组都在原有容量上填充，从池中取出的块通常不需要重新分配
+    m_data.resize(header.dataSize);
+    memcpy(m_data.data(), p, size_t(header.dataSize));
+    p += header.dataSize;
+    ensureColumns(header.slotCount);
+    bool valid = m_cells.size() == header.slotCount;
+    for (int i = 0; valid && i < m_cells.size(); ++i) {
+        valid = readArray(p, end, header.rowCount, m_cells[i]);
+    }
+    if (!valid || !readArray(p, end, header.rowCount + 1, m_rowDataStarts) || p != end) {
+        clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+#ifndef ROWBLOCK_H
+#define ROWBLOCK_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include "csvtokenizer.h"
+
+enum class Encoding; // 定义见csvreader.h
+class TextDecoder;
+
+/**
+ * @class RowBlock
+ * @brief 一批连续数据行的原始字节和字段位置，单元格只在显示时才解码
+ *
+ * 读取时每条记录只做切分，字段字节首尾相连复制到同一个缓冲区（字节区），字段位置按列存放：
+ * 每一列一个以行号为下标的数组，元素只有字节区偏移和长度两个32位整数。取一个单元格是两次数组下标访问，
+ * 不按行、按字段分配QString，也不在行内查找字段。预加载但从未显示的行不产生解码开销。
+ * 设置了列投影时只复制投影中的字段，其余字段切分后直接丢弃，块的大小只与显示的列有关。
+ * 读取时由RowBlockPool分配，填充完成后只读，以QSharedPointer<const RowBlock>在线程之间共享。
+ */
+class RowBlock
+{
+public:
+    RowBlock();
+
+    /**
+     * @brief 块中字节的编码，决定切分时的码元宽度，应在追加记录前设置
+     */
+    void setEncoding(Encoding encoding);
+    Encoding encoding() const;
+
+    /**
+     * @brief 设置列投影，应在追加记录前设置
+     * @param columns 需要保存的原始列号（升序），为空时保存全部列
+     */
+    void setColumns(const QVector<int> &columns);
+    const QVector<int> &columns() const;
+
+    /**
+     * @brief 切分一条记录并追加到块末尾
+     * @param data 记录起始地址（可含行尾换行符，首尾空白会被去掉）
+     * @param size 记录字节数
+     * @param delimiter 分隔符
+     * @param spans 切分用的临时缓冲区，由调用方在多条记录之间复用
+     */
+    void appendRecord(const char *data, int size, char delimiter, QVector<FieldSpan> &spans);
+
+    /**
+     * @brief 清空所有行，列数归零并去掉列投影，保留字节区和各列数组已分配的容量（块回到缓冲池时调用）
+     */
+    void clear();
+
+    int rowCount() const;
+    bool isEmpty() const;
+
+    /**
+     * @brief 指定行是否保存了该列（不在投影中或该行列数不足时返回false）
+     * @param column 文件中的原始列号
+     */
+    bool hasField(int row, int column) const;
+
+    /**
+     * @brief 解码一个单元格，需要时先去掉引号
+     * @param column 文件中的原始列号
+     * @param decoder 与块编码一致的解码器
+     */
+    QString field(int row, int column, TextDecoder &decoder) const;
+
+    /**
+     * @brief 块占用的字节数（原始字节和各列的字段位置）
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief 把块的全部内容序列化为一段连续字节（用于压缩存放，只在本进程内使用）
+     */
+    QByteArray toBytes() const;
+
+    /**
+     * @brief 由toBytes的结果还原到本块，复用已分配的容量（块应为空，如刚从RowBlockPool取出）
+     * @return 数据长度不一致时清空块并返回false
+     */
+    bool restore(const QByteArray &bytes);
+
+private:
+    QByteArray m_data;             // 各记录去掉首尾空白后的原始字节，首尾相连
+    // 一个单元格在m_data中的位置
+    struct Cell {
+        quint32 offset;
+        quint32 length; // 最高位为1表示字段中含有需要处理的引号
+    };
+    static constexpr quint32 UnescapeFlag = 0x80000000u;
+    static constexpr quint32 MissingCell = 0xFFFFFFFFu; // 该行没有这一列（列数不足）
+
+    QVector<QVector<Cell>> m_cells; // 每个保存的列一个数组，下标为行号；未设投影时下标即原始列号
+    QVector<QVector<Cell>> m_spareColumns; // clear后留下的空列数组，增加列时复用，保留已分配的容量
+    QVector<int> m_rowDataStarts;  // 每行字节在m_data中的起始位置，末尾另有一个结束位置
+    QVector<int> m_columns;        // 列投影（升序的原始列号），为空表示全部列
+    QVector<int> m_columnSlots;    // 设置投影时原始列号到m_cells下标的查找表，不在投影中为-1
+    int columnSlot(int column) const; // 原始列号对应的m_cells下标，不在投影中返回-1
+    void ensureColumns(int count); // 未设投影时扩展列数，新列在已有的行中为MissingCell
+    Encoding m_encoding;
+};
+
+#endif // ROWBLOCK_H
@@ -0,0 +1,205 @@
+#include "rowblockcache.h"
+#include "blockcompressor.h"
+#include "rowblockpool.h"
+#include <climits>
+
+namespace {
+
+// 字节数换算为QCache的代价（KB），至少为1
+int costOf(qint64 bytes)
+{
+    return static_cast<int>(qBound<qint64>(1, bytes / 1024, INT_MAX));
+}
+
+}
+
+RowBlockCache::HotEntry::~HotEntry()
+{
+    if (owner) {
+        owner->demote(blockNumber, *block);
+    }
+}
+
+RowBlockCache::ColdEntry::~ColdEntry()
+{
+    owner->m_coldRawSize -= rawSize;
+}
+
+RowBlockCache::RowBlockCache(qint64 budget, qint64 coldBudget)
+    : m_budget(0)
+    , m_coldBudget(0)
+    , m_coldRawSize(0)
+    , m_dropping(false)
+    , m_hotHits(0)
+    , m_coldHits(0)
+    , m_misses(0)
+{
+    setBudget(budget);
+    setColdBudget(coldBudget);
+}
+
+RowBlockCache::~RowBlockCache()
+{
+    m_dropping = true;
+    m_cache.clear();
+    m_coldCache.clear();
+}
+
+void RowBlockCache::setBudget(qint64 bytes)
+{
+    m_budget = qMax<qint64>(0, bytes);
+    m_cache.setMaxCost(costOf(m_budget)); // 淘汰的块进入冷层
+}
+
+qint64 RowBlockCache::budget() const
+{
+    return m_budget;
+}
+
+void RowBlockCache::setColdBudget(qint64 bytes)
+{
+    m_coldBudget = qMax<qint64>(0, bytes);
+    if (m_coldBudget == 0) {
+        m_coldCache.clear();
+    }
+    m_coldCache.setMaxCost(costOf(m_coldBudget));
+}
+
+qint64 RowBlockCache::coldBudget() const
+{
+    return m_coldBudget;
+}
+
+QSharedPointer<const RowBlock> RowBlockCache::find(qint64 blockNumber)
+{
+    const HotEntry *entry = m_cache.object(blockNumber); // 命中时同时移到最近使用的位置
+    if (entry) {
+        m_hotHits++;
+        return entry->block;
+    }
+
+    ColdEntry *cold = m_coldCache.take(blockNumber);
+    if (cold) {
+        // 解压到池中的块，复用其缓冲区；冷层命中最频繁时也不为每个块重新分配
+        const QSharedPointer<RowBlock> block = RowBlockPool::instance().acquire();
+        const bool restored = block->restore(BlockCompressor::decompress(cold->compressed));
+        delete cold;
+        if (restored && !block->isEmpty()) {
+            m_coldHits++;
+            // 回到热层，热层因此淘汰的块进入冷层
+            insert(blockNumber, block);
+            return block;
+        }
+    }
+
+    m_misses++;
+    return QSharedPointer<const RowBlock>();
+}
+
+void RowBlockCache::insert(qint64 blockNumber, const QSharedPointer<const RowBlock> &block)
+{
+    if (m_budget <= 0) {
+        demote(blockNumber, *block);
+        return;
+    }
+    const int cost = costOf(block->memoryUsage());
+    if (cost > m_cache.maxCost()) {
+        return;
+    }
+    // 同一块号已在热层时先取出旧条目直接丢弃，否则QCache删除它时会把一份重复的块压缩进冷层
+    if (HotEntry *previous = m_cache.take(blockNumber)) {
+        previous->owner = nullptr;
+        delete previous;
+    }
+    HotEntry *entry = new HotEntry{block, blockNumber, this};
+    m_cache.insert(blockNumber, entry, cost);
+}
+
+void RowBlockCache::demote(qint64 blockNumber, const RowBlock &block)
+{
+    if (m_dropping || m_coldBudget <= 0 || block.isEmpty()) {
+        return;
+    }
+    const QByteArray raw = block.toBytes();
+    const QByteArray compressed = BlockCompressor::compress(raw);
+    if (compressed.isEmpty()) {
+        return;
+    }
+    // 插入失败时QCache会删除entry，析构时再减去
+    m_coldRawSize += raw.size();
+    m_coldCache.insert(blockNumber, new ColdEntry{compressed, raw.size(), this}, costOf(compressed.size()));
+}
+
+void RowBlockCache::removeFrom(qint64 blockNumber)
+{
+    m_dropping = true;
+    const auto keys = m_cache.keys();
+    for (qint64 key : keys) {
+        if (key >= blockNumber) {
+            m_cache.remove(key);
+        }
+    }
+    m_dropping = false;
+
+    const auto coldKeys = m_coldCache.keys();
+    for (qint64 key : coldKeys) {
+        if (key >= blockNumber) {
+            m_coldCache.remove(key);
+        }
+    }
+}
+
+void RowBlockCache::clear()
+{
+    m_dropping = true;
+    m_cache.clear();
+    m_dropping = false;
+    m_coldCache.clear();
+    m_hotHits = 0;
+    m_coldHits = 0;
+    m_misses = 0;
+}
+
+qint64 RowBlockCache::hotHits() const
+{
+    return m_hotHits;
+}
+
+qint64 RowBlockCache::coldHits() const
+{
+    return m_coldHits;
+}
+
+qint64 RowBlockCache::misses() const
+{
+    return m_misses;
+}
+
+qint64 RowBlockCache::memoryUsage() const
+{
+    return qint64(m_cache.totalCost()) * 1024;
+}
+
+qint64 RowBlockCache::coldMemoryUsage() const
+{
+    return qint64(m_coldCache.totalCost()) * 1024;
+}
+
+qint64 RowBlockCache::coldRawSize() const
+{
+    return m_coldRawSize;
+}
+
+BlockCacheStats RowBlockCache::stats() const
+{
+    BlockCacheStats stats;
+    stats.hotHits = m_hotHits;
+    stats.coldHits = m_coldHits;
+    stats.misses = m_misses;
+    stats.hotBytes = memoryUsage();
+    stats.hotBudget = m_budget;
+    stats.coldBytes = coldMemoryUsage();
+    stats.coldRawBytes = m_coldRawSize;
+    stats.coldBudget = m_coldBudget;
+    return stats;
+}
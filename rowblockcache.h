@@ -0,0 +1,109 @@
+#ifndef ROWBLOCKCACHE_H
+#define ROWBLOCKCACHE_H
+
+#include <QCache>
+#include <QSharedPointer>
+#include "rowblock.h"
+
+// 行块缓存的统计，随读取结果交给界面线程显示
+struct BlockCacheStats {
+    qint64 hotHits = 0;      // 热层命中次数
+    qint64 coldHits = 0;     // 冷层命中次数
+    qint64 misses = 0;       // 两层都未命中的次数
+    qint64 hotBytes = 0;     // 热层占用的字节数
+    qint64 hotBudget = 0;    // 热层内存预算
+    qint64 coldBytes = 0;    // 冷层占用的字节数（压缩后）
+    qint64 coldRawBytes = 0; // 冷层中的块压缩前的字节数
+    qint64 coldBudget = 0;   // 冷层内存预算（按压缩后的字节数）
+};
+
+/**
+ * @class RowBlockCache
+ * @brief 已切分的行块缓存，滚动回刚离开的区域时不再读取和切分文件
+ *
+ * 文件按BlockRows行划分为固定的块，以块号为键，分两层：
+ * 热层保存可直接使用的块；从热层淘汰的块压缩后（见BlockCompressor）放入冷层，
+ * 冷层命中时解压并回到热层，比重新从磁盘读取和切分快得多。两层各有独立的内存预算，
+ * 按占用的字节数计入，超出预算时淘汰最近最少使用的块（由QCache实现）。
+ * 两层的命中分别计数，便于调整各自的预算。只在工作线程中使用，不加锁。
+ * 热层中的块是共享的只读块，读取结果直接引用它们，块被淘汰后仍在使用的引用不受影响。
+ */
+class RowBlockCache
+{
+public:
+    static constexpr int BlockRows = 256; // 每个块的行数
+
+    explicit RowBlockCache(qint64 budget = 64LL * 1024 * 1024, qint64 coldBudget = 64LL * 1024 * 1024);
+    ~RowBlockCache();
+
+    /**
+     * @brief 设置热层内存预算，超出的部分立即淘汰（进入冷层），0表示热层不缓存
+     */
+    void setBudget(qint64 bytes);
+    qint64 budget() const;
+
+    /**
+     * @brief 设置冷层内存预算（按压缩后的字节数），0表示不保留淘汰的块
+     */
+    void setColdBudget(qint64 bytes);
+    qint64 coldBudget() const;
+
+    /**
+     * @brief 依次在热层和冷层查找块并记录命中/未命中
+     * @return 不在缓存中返回空指针
+     */
+    QSharedPointer<const RowBlock> find(qint64 blockNumber);
+
+    /**
+     * @brief 缓存一个完整的块，单个块超出热层预算时不缓存
+     */
+    void insert(qint64 blockNumber, const QSharedPointer<const RowBlock> &block);
+
+    /**
+     * @brief 删除两层中块号不小于blockNumber的所有块（文件追加后末尾的块可能已变化）
+     */
+    void removeFrom(qint64 blockNumber);
+
+    /**
+     * @brief 清空两层缓存和命中统计（打开新文件或列投影变化时）
+     */
+    void clear();
+
+    qint64 hotHits() const;  // 热层命中次数
+    qint64 coldHits() const; // 冷层命中次数
+    qint64 misses() const;   // 两层都未命中的次数
+    qint64 memoryUsage() const;     // 热层占用的字节数（按KB计入后的近似值）
+    qint64 coldMemoryUsage() const; // 冷层占用的字节数（压缩后）
+    qint64 coldRawSize() const;     // 冷层中的块压缩前的字节数
+    BlockCacheStats stats() const;  // 以上统计和当前预算的快照
+
+private:
+    // 热层中的块，被QCache淘汰（删除）时把自身压缩存入冷层
+    struct HotEntry {
+        QSharedPointer<const RowBlock> block;
+        qint64 blockNumber;
+        RowBlockCache *owner;
+        ~HotEntry();
+    };
+    // 冷层中的块，删除时（包括被QCache淘汰）从未压缩大小的统计中减去
+    struct ColdEntry {
+        QByteArray compressed;
+        qint64 rawSize;
+        RowBlockCache *owner;
+        ~ColdEntry();
+    };
+
+    void demote(qint64 blockNumber, const RowBlock &block); // 压缩热层淘汰的块并放入冷层
+
+    QCache<qint64, HotEntry> m_cache;      // 热层，代价以KB计，Qt5中QCache的代价为int
+    QCache<qint64, ColdEntry> m_coldCache; // 冷层，代价以压缩后的KB计
+    qint64 m_budget;
+    qint64 m_coldBudget;
+    qint64 m_coldRawSize;
+    bool m_dropping; // 为true时从热层删除的块直接丢弃，不进入冷层
+    qint64 m_hotHits;
+    qint64 m_coldHits;
+    qint64 m_misses;
+};
+
+#endif // ROWBLOCKCACHE_H
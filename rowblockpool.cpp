@@ -0,0 +1,65 @@
+#include "rowblockpool.h"
+
+RowBlockPool &RowBlockPool::instance()
+{
+    // 不析构：块可能在静态对象析构之后才释放（如退出时仍被缓存或结果队列持有），删除器始终要能访问池
+    static RowBlockPool *pool = new RowBlockPool();
+    return *pool;
+}
+
+RowBlockPool::RowBlockPool()
+    : m_allocations(0)
+    , m_reuses(0)
+{
+    m_free.reserve(MaxFreeBlocks);
+}
+
+QSharedPointer<RowBlock> RowBlockPool::acquire()
+{
+    RowBlock *block = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_free.isEmpty()) {
+            block = m_free.takeLast();
+            m_reuses++;
+        } else {
+            m_allocations++;
+        }
+    }
+    if (!block) {
+        block = new RowBlock();
+    }
+    return QSharedPointer<RowBlock>(block, [this](RowBlock *released) { release(released); });
+}
+
+void RowBlockPool::release(RowBlock *block)
+{
+    // 在锁外清空，释放引用的线程承担这部分开销
+    block->clear();
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_free.size() < MaxFreeBlocks) {
+            m_free.append(block);
+            return;
+        }
+    }
+    delete block;
+}
+
+qint64 RowBlockPool::allocations() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_allocations;
+}
+
+qint64 RowBlockPool::reuses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_reuses;
+}
+
+int RowBlockPool::freeCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_free.size();
+}
@@ -0,0 +1,47 @@
+#ifndef ROWBLOCKPOOL_H
+#define ROWBLOCKPOOL_H
+
+#include <QVector>
+#include <QMutex>
+#include <QSharedPointer>
+#include "rowblock.h"
+
+/**
+ * @class RowBlockPool
+ * @brief 行块的回收池，读取新块时复用已释放块的缓冲区
+ *
+ * 工作线程从池中取块并填充，填充完成后块只以QSharedPointer<const RowBlock>的形式传递：
+ * 缓存、读取结果和表格模型共享同一个块，跨线程传递不复制数据。
+ * 最后一个引用释放时（在任一线程中）块被清空并放回池中，字节区和各列数组保留已分配的容量，
+ * 下一个块按相同的行数填充时不再分配内存。池中最多保留MaxFreeBlocks个空闲块，多出的直接释放。
+ * 池本身在堆上创建且从不销毁，进程退出时仍存活的块也能安全地归还。
+ */
+class RowBlockPool
+{
+public:
+    static constexpr int MaxFreeBlocks = 64;
+
+    static RowBlockPool &instance();
+
+    /**
+     * @brief 取一个空块（线程安全），最后一个引用释放时自动回到池中
+     */
+    QSharedPointer<RowBlock> acquire();
+
+    qint64 allocations() const; // 新分配的块数
+    qint64 reuses() const;      // 从池中复用的块数
+    int freeCount() const;      // 池中的空闲块数
+
+private:
+    RowBlockPool(); // 只由instance创建，进程结束前不销毁
+    Q_DISABLE_COPY(RowBlockPool)
+
+    void release(RowBlock *block); // 清空块并放回池中
+
+    mutable QMutex m_mutex; // 保护空闲块列表和统计
+    QVector<RowBlock *> m_free;
+    qint64 m_allocations;
+    qint64 m_reuses;
+};
+
+#endif // ROWBLOCKPOOL_H
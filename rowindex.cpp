@@ -0,0 +1,176 @@
+#include "rowindex.h"
+#include <QFile>
+#include <algorithm>
+
+RowIndex::RowIndex()
+    : m_rowCount(0)
+    , m_stride(1)
+    , m_memoryBudget(0)
+    , m_mappedBlockBases(nullptr)
+    , m_mappedRelativeOffsets(nullptr)
+    , m_mappedCheckpointCount(0)
+{
+}
+
+void RowIndex::clear()
+{
+    m_blockBases.clear();
+    m_relativeOffsets.clear();
+    m_overflowOffsets.clear();
+    m_mappedFile.reset();
+    m_mappedBlockBases = nullptr;
+    m_mappedRelativeOffsets = nullptr;
+    m_mappedCheckpointCount = 0;
+    m_rowCount = 0;
+    m_stride = 1;
+}
+
+void RowIndex::setMemoryBudget(qint64 bytes)
+{
+    m_memoryBudget = qMax<qint64>(0, bytes);
+    while (m_memoryBudget > 0 && memoryUsage() > m_memoryBudget && checkpointCount() > 1) {
+        doubleStride();
+    }
+}
+
+qint64 RowIndex::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void RowIndex::append(qint64 offset)
+{
+    if (m_rowCount % m_stride == 0) {
+        if (m_mappedFile) {
+            detachMapped();
+        }
+        appendCheckpoint(offset);
+        // 超出预算时采样间隔翻倍，均摊下来每行仍是O(1)
+        if (m_memoryBudget > 0 && memoryUsage() > m_memoryBudget && m_relativeOffsets.size() > 1) {
+            doubleStride();
+        }
+    }
+    m_rowCount++;
+}
+
+qint64 RowIndex::rowCount() const
+{
+    return m_rowCount;
+}
+
+bool RowIndex::isEmpty() const
+{
+    return m_rowCount == 0;
+}
+
+int RowIndex::stride() const
+{
+    return m_stride;
+}
+
+bool RowIndex::locate(qint64 row, qint64 *checkpointOffset, qint64 *rowsToSkip) const
+{
+    if (row < 0 || row >= m_rowCount) {
+        return false;
+    }
+
+    const qint64 checkpoint = row / m_stride;
+    if (checkpointOffset) {
+        *checkpointOffset = this->checkpointOffset(checkpoint);
+    }
+    if (rowsToSkip) {
+        *rowsToSkip = row - checkpoint * m_stride;
+    }
+    return true;
+}
+
+qint64 RowIndex::memoryUsage() const
+{
+    const qint64 checkpoints = checkpointCount();
+    const qint64 blocks = (checkpoints + (1 << BlockShift) - 1) >> BlockShift;
+    return blocks * static_cast<qint64>(sizeof(qint64))
+           + checkpoints * static_cast<qint64>(sizeof(quint32))
+           + static_cast<qint64>(m_overflowOffsets.size()) * 2 * static_cast<qint64>(sizeof(qint64));
+}
+
+qint64 RowIndex::checkpointCount() const
+{
+    return m_mappedFile ? m_mappedCheckpointCount : m_relativeOffsets.size();
+}
+
+const qint64 *RowIndex::blockBases() const
+{
+    return m_mappedFile ? m_mappedBlockBases : m_blockBases.constData();
+}
+
+const quint32 *RowIndex::relativeOffsets() const
+{
+    return m_mappedFile ? m_mappedRelativeOffsets : m_relativeOffsets.constData();
+}
+
+void RowIndex::detachMapped()
+{
+    const qint64 checkpoints = m_mappedCheckpointCount;
+    const qint64 blocks = (checkpoints + (1 << BlockShift) - 1) >> BlockShift;
+    m_blockBases.resize(blocks);
+    m_relativeOffsets.resize(checkpoints);
+    std::copy(m_mappedBlockBases, m_mappedBlockBases + blocks, m_blockBases.begin());
+    std::copy(m_mappedRelativeOffsets, m_mappedRelativeOffsets + checkpoints, m_relativeOffsets.begin());
+
+    m_mappedFile.reset();
+    m_mappedBlockBases = nullptr;
+    m_mappedRelativeOffsets = nullptr;
+    m_mappedCheckpointCount = 0;
+}
+
+void RowIndex::appendCheckpoint(qint64 offset)
+{
+    const qint64 checkpoint = m_relativeOffsets.size();
+    if ((checkpoint & ((1 << BlockShift) - 1)) == 0) {
+        m_blockBases.append(offset);
+    }
+
+    const qint64 relative = offset - m_blockBases.last();
+    if (relative >= OverflowMarker) {
+        m_overflowOffsets.insert(checkpoint, offset);
+        m_relativeOffsets.append(OverflowMarker);
+    } else {
+        m_relativeOffsets.append(static_cast<quint32>(relative));
+    }
+}
+
+qint64 RowIndex::checkpointOffset(qint64 checkpoint) const
+{
+    const quint32 relative = relativeOffsets()[checkpoint];
+    if (relative == OverflowMarker) {
+        return m_overflowOffsets.value(checkpoint);
+    }
+    return blockBases()[checkpoint >> BlockShift] + relative;
+}
+
+void RowIndex::doubleStride()
+{
+    // 保留偶数号检查点，即新间隔下的每个检查点
+    const qint64 checkpoints = checkpointCount();
+    QVector<qint64> kept;
+    kept.reserve((checkpoints + 1) / 2);
+    for (qint64 i = 0; i < checkpoints; i += 2) {
+        kept.append(checkpointOffset(i));
+    }
+
+    m_mappedFile.reset();
+    m_mappedBlockBases = nullptr;
+    m_mappedRelativeOffsets = nullptr;
+    m_mappedCheckpointCount = 0;
+    m_blockBases.clear();
+    m_relativeOffsets.clear();
+    m_overflowOffsets.clear();
+    m_blockBases.reserve((kept.size() >> BlockShift) + 1);
+    m_relativeOffsets.reserve(kept.size());
+    for (qint64 offset : kept) {
+        appendCheckpoint(offset);
+    }
+    m_relativeOffsets.squeeze();
+    m_blockBases.squeeze();
+    m_stride *= 2;
+}
@@ -0,0 +1,96 @@
+#ifndef ROWINDEX_H
+#define ROWINDEX_H
+
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+
+class QFile;
+
+/**
+ * @class RowIndex
+ * @brief 紧凑的行号到文件偏移索引，替代每行一个节点的QMap<qint64, qint64>
+ *
+ * 每stride行保存一个检查点。检查点按64个一组存储：每组一个64位基准偏移，
+ * 组内每个检查点只存相对基准的32位差值，每行约4.1字节。
+ * 超出内存预算时采样间隔翻倍，查找非检查点行时由调用方从最近的检查点向后跳过若干行。
+ *
+ * 检查点数组也可以直接指向内存映射的缓存文件（见IndexCache），首次追加时才复制为自有存储。
+ */
+class RowIndex
+{
+public:
+    RowIndex();
+
+    /**
+     * @brief 清空索引，保留内存预算设置
+     */
+    void clear();
+
+    /**
+     * @brief 设置索引的内存预算
+     * @param bytes 字节数，0表示不限制（每行都保存检查点）
+     */
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+
+    /**
+     * @brief 按行号顺序追加下一行的起始偏移
+     * @param offset 行起始位置在文件中的偏移，必须不小于上一次追加的偏移
+     */
+    void append(qint64 offset);
+
+    /**
+     * @brief 已记录的行数（含表头行）
+     */
+    qint64 rowCount() const;
+    bool isEmpty() const;
+
+    /**
+     * @brief 当前采样间隔，1表示每行都有精确偏移
+     */
+    int stride() const;
+
+    /**
+     * @brief 定位指定行，O(1)
+     * @param row 行号（0为表头）
+     * @param checkpointOffset 输出：不晚于该行的最近检查点偏移
+     * @param rowsToSkip 输出：从检查点开始还需跳过的行数
+     * @return 行号超出范围时返回false
+     */
+    bool locate(qint64 row, qint64 *checkpointOffset, qint64 *rowsToSkip) const;
+
+    /**
+     * @brief 索引当前占用的内存字节数
+     */
+    qint64 memoryUsage() const;
+
+private:
+    friend class IndexCache; // 序列化/映射缓存文件时直接访问检查点数组
+
+    static constexpr int BlockShift = 6; // 每组 1<<6 = 64 个检查点
+    static constexpr quint32 OverflowMarker = 0xFFFFFFFFu; // 差值超出32位时的占位值
+
+    void appendCheckpoint(qint64 offset);
+    qint64 checkpointOffset(qint64 checkpoint) const;
+    void doubleStride(); // 丢弃一半检查点，采样间隔翻倍
+    qint64 checkpointCount() const;
+    const qint64 *blockBases() const;
+    const quint32 *relativeOffsets() const;
+    void detachMapped(); // 把映射的只读数组复制为自有存储
+
+    QVector<qint64> m_blockBases;           // 每组检查点的基准偏移
+    QVector<quint32> m_relativeOffsets;     // 每个检查点相对组基准的偏移
+    QHash<qint64, qint64> m_overflowOffsets; // 与组基准相差4GB以上的检查点（极少出现）
+    qint64 m_rowCount;
+    int m_stride;
+    qint64 m_memoryBudget;
+
+    // 映射自缓存文件的只读检查点数组，m_mappedFile保持映射有效
+    QSharedPointer<QFile> m_mappedFile;
+    const qint64 *m_mappedBlockBases;
+    const quint32 *m_mappedRelativeOffsets;
+    qint64 m_mappedCheckpointCount;
+};
+
+#endif // ROWINDEX_H
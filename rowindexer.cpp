@@ -0,0 +1,297 @@
+#include "rowindexer.h"
+#include "cpufeatures.h"
+#include "quotemask.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(CSV_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using FindRowStartsFn = void (*)(const char *, qint64, qint64, QVector<qint64> &);
+
+// 标量实现：memchr在多数C库中本身已做过优化，作为所有平台的兜底路径
+void findRowStartsScalar(const char *data, qint64 size, qint64 baseOffset, QVector<qint64> &rowStarts)
+{
+    const char *p = data;
+    const char *end = data + size;
+    while (p < end) {
+        const void *found = std::memchr(p, '\n', static_cast<size_t>(end - p));
+        if (!found) {
+            break;
+        }
+        p = static_cast<const char *>(found) + 1;
+        rowStarts.append(baseOffset + (p - data));
+    }
+}
+
+using ScanQuotedFn = void (*)(const char *, qint64, qint64, bool &, QVector<qint64> *, QVector<qint64> *);
+
+// 带引号状态的扫描：parity为当前是否处于引号内（即已遇到的引号个数为奇数），
+// 换行符按所处状态分别追加到outsideRows/insideRows，传入nullptr表示丢弃该组
+void scanQuotedScalar(const char *data, qint64 size, qint64 baseOffset, bool &parity,
+                      QVector<qint64> *outsideRows, QVector<qint64> *insideRows)
+{
+    for (qint64 i = 0; i < size; ++i) {
+        const char ch = data[i];
+        if (ch == '"') {
+            parity = !parity;
+        } else if (ch == '\n') {
+            QVector<qint64> *target = parity ? insideRows : outsideRows;
+            if (target) {
+                target->append(baseOffset + i + 1);
+            }
+        }
+    }
+}
+
+// UTF-16按对齐的码元逐个扫描，不足一个码元的尾字节忽略
+template <CodeUnit Unit>
+void findRowStartsWide(const char *data, qint64 size, qint64 baseOffset, QVector<qint64> &rowStarts)
+{
+    for (qint64 i = 0; i + 1 < size; i += 2) {
+        if (loadCodeUnit(data + i, Unit) == '\n') {
+            rowStarts.append(baseOffset + i + 2);
+        }
+    }
+}
+
+template <CodeUnit Unit>
+void scanQuotedWide(const char *data, qint64 size, qint64 baseOffset, bool &parity,
+                    QVector<qint64> *outsideRows, QVector<qint64> *insideRows)
+{
+    for (qint64 i = 0; i + 1 < size; i += 2) {
+        const quint16 ch = loadCodeUnit(data + i, Unit);
+        if (ch == '"') {
+            parity = !parity;
+        } else if (ch == '\n') {
+            QVector<qint64> *target = parity ? insideRows : outsideRows;
+            if (target) {
+                target->append(baseOffset + i + 2);
+            }
+        }
+    }
+}
+
+#if defined(CSV_SIMD_X86)
+
+// 将一个换行符位掩码展开为行起始偏移
+inline void appendMaskPositions(quint64 mask, qint64 blockOffset, QVector<qint64> &rowStarts)
+{
+    while (mask) {
+        rowStarts.append(blockOffset + qCountTrailingZeroBits(mask) + 1);
+        mask &= mask - 1; // 清除最低位的1
+    }
+}
+
+// 按64字节块的引号区域掩码分类换行符，parity更新为块末尾的引号状态。
+// insideMask已按块起点的引号状态修正，不需要逐个引号处理
+inline void classifyBlock(quint64 insideMask, quint64 newlineMask, qint64 blockOffset, bool &parity,
+                          QVector<qint64> *outsideRows, QVector<qint64> *insideRows)
+{
+    if (outsideRows) {
+        appendMaskPositions(newlineMask & ~insideMask, blockOffset, *outsideRows);
+    }
+    if (insideRows) {
+        appendMaskPositions(newlineMask & insideMask, blockOffset, *insideRows);
+    }
+    parity = (insideMask >> 63) != 0;
+}
+
+CSV_TARGET("sse2")
+void findRowStartsSse2(const char *data, qint64 size, qint64 baseOffset, QVector<qint64> &rowStarts)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    qint64 i = 0;
+    // 每次处理64字节，合并成一个64位掩码，绝大多数块中没有换行符，只需一次判断
+    for (; i + 64 <= size; i += 64) {
+        const __m128i *p = reinterpret_cast<const __m128i *>(data + i);
+        const quint64 m0 = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p), newline)));
+        const quint64 m1 = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + 1), newline)));
+        const quint64 m2 = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + 2), newline)));
+        const quint64 m3 = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(p + 3), newline)));
+        appendMaskPositions(m0 | (m1 << 16) | (m2 << 32) | (m3 << 48), baseOffset + i, rowStarts);
+    }
+    findRowStartsScalar(data + i, size - i, baseOffset + i, rowStarts);
+}
+
+CSV_TARGET("avx2")
+void findRowStartsAvx2(const char *data, qint64 size, qint64 baseOffset, QVector<qint64> &rowStarts)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    qint64 i = 0;
+    for (; i + 64 <= size; i += 64) {
+        const __m256i *p = reinterpret_cast<const __m256i *>(data + i);
+        const quint64 lo = static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(p), newline)));
+        const quint64 hi = static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(p + 1), newline)));
+        appendMaskPositions(lo | (hi << 32), baseOffset + i, rowStarts);
+    }
+    findRowStartsScalar(data + i, size - i, baseOffset + i, rowStarts);
+}
+
+CSV_TARGET("sse2")
+void scanQuotedSse2(const char *data, qint64 size, qint64 baseOffset, bool &parity,
+                    QVector<qint64> *outsideRows, QVector<qint64> *insideRows)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i quote = _mm_set1_epi8('"');
+    qint64 i = 0;
+    for (; i + 64 <= size; i += 64) {
+        const __m128i *p = reinterpret_cast<const __m128i *>(data + i);
+        quint64 newlineMask = 0;
+        quint64 quoteMask = 0;
+        for (int part = 0; part < 4; ++part) {
+            const __m128i chunk = _mm_loadu_si128(p + part);
+            newlineMask |= static_cast<quint64>(static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)))) << (16 * part);
+            quoteMask |= static_cast<quint64>(static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << (16 * part);
+        }
+        classifyBlock(QuoteMask::prefixXorShift(quoteMask) ^ QuoteMask::carry(parity), newlineMask, baseOffset + i, parity, outsideRows, insideRows);
+    }
+    scanQuotedScalar(data + i, size - i, baseOffset + i, parity, outsideRows, insideRows);
+}
+
+CSV_TARGET("avx2,pclmul")
+void scanQuotedAvx2(const char *data, qint64 size, qint64 baseOffset, bool &parity,
+                    QVector<qint64> *outsideRows, QVector<qint64> *insideRows)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i quote = _mm256_set1_epi8('"');
+    qint64 i = 0;
+    for (; i + 64 <= size; i += 64) {
+        const __m256i *p = reinterpret_cast<const __m256i *>(data + i);
+        const __m256i lo = _mm256_loadu_si256(p);
+        const __m256i hi = _mm256_loadu_si256(p + 1);
+        const quint64 newlineMask = static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline)))
+                                    | (static_cast<quint64>(static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)))) << 32);
+        const quint64 quoteMask = static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, quote)))
+                                  | (static_cast<quint64>(static_cast<quint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, quote)))) << 32);
+        classifyBlock(QuoteMask::prefixXorClmul(quoteMask) ^ QuoteMask::carry(parity), newlineMask, baseOffset + i, parity, outsideRows, insideRows);
+    }
+    scanQuotedScalar(data + i, size - i, baseOffset + i, parity, outsideRows, insideRows);
+}
+
+#endif
+
+FindRowStartsFn resolveFindRowStarts()
+{
+#if defined(CSV_SIMD_X86)
+    if (CpuFeatures::hasAvx2()) {
+        return findRowStartsAvx2;
+    }
+    if (CpuFeatures::hasSse2()) {
+        return findRowStartsSse2;
+    }
+#endif
+    return findRowStartsScalar;
+}
+
+// 首次使用时选定实现，之后直接调用函数指针
+FindRowStartsFn findRowStartsImpl()
+{
+    static const FindRowStartsFn impl = resolveFindRowStarts();
+    return impl;
+}
+
+FindRowStartsFn findRowStartsFor(CodeUnit unit)
+{
+    switch (unit) {
+    case CodeUnit::Utf16LE:
+        return findRowStartsWide<CodeUnit::Utf16LE>;
+    case CodeUnit::Utf16BE:
+        return findRowStartsWide<CodeUnit::Utf16BE>;
+    default:
+        return findRowStartsImpl();
+    }
+}
+
+ScanQuotedFn resolveScanQuoted()
+{
+#if defined(CSV_SIMD_X86)
+    if (CpuFeatures::hasAvx2() && CpuFeatures::hasPclmul()) {
+        return scanQuotedAvx2;
+    }
+    if (CpuFeatures::hasSse2()) {
+        return scanQuotedSse2;
+    }
+#endif
+    return scanQuotedScalar;
+}
+
+ScanQuotedFn scanQuotedImpl()
+{
+    static const ScanQuotedFn impl = resolveScanQuoted();
+    return impl;
+}
+
+ScanQuotedFn scanQuotedFor(CodeUnit unit)
+{
+    switch (unit) {
+    case CodeUnit::Utf16LE:
+        return scanQuotedWide<CodeUnit::Utf16LE>;
+    case CodeUnit::Utf16BE:
+        return scanQuotedWide<CodeUnit::Utf16BE>;
+    default:
+        return scanQuotedImpl();
+    }
+}
+
+}
+
+void ChunkScanResult::clear()
+{
+    rowStartsIfOutside.clear();
+    rowStartsIfInside.clear();
+    togglesQuoteState = false;
+}
+
+void RowIndexer::findRowStarts(const char *data, qint64 size, qint64 baseOffset, QVector<qint64> &rowStarts, CodeUnit unit)
+{
+    if (!data || size <= 0) {
+        return;
+    }
+    findRowStartsFor(unit)(data, size, baseOffset, rowStarts);
+}
+
+void RowIndexer::scanChunk(const char *data, qint64 size, qint64 baseOffset, ChunkScanResult &result, CodeUnit unit)
+{
+    bool parity = false;
+    if (data && size > 0) {
+        scanQuotedFor(unit)(data, size, baseOffset, parity, &result.rowStartsIfOutside, &result.rowStartsIfInside);
+    }
+    result.togglesQuoteState = parity;
+}
+
+void RowIndexer::findRecordStarts(const char *data, qint64 size, qint64 baseOffset, bool &inQuotes, QVector<qint64> &rowStarts, CodeUnit unit)
+{
+    if (!data || size <= 0) {
+        return;
+    }
+    scanQuotedFor(unit)(data, size, baseOffset, inQuotes, &rowStarts, nullptr);
+}
+
+QString RowIndexer::implementationName()
+{
+    // 按实际选定的函数指针命名：带引号扫描需要PCLMUL，缺少时回退到SSE2，与换行扫描不一定相同
+    const ScanQuotedFn scan = scanQuotedImpl();
+    const FindRowStartsFn find = findRowStartsImpl();
+    QString scanName = QStringLiteral("Scalar");
+    QString findName = QStringLiteral("Scalar");
+#if defined(CSV_SIMD_X86)
+    if (scan == scanQuotedAvx2) {
+        scanName = QStringLiteral("AVX2+PCLMUL");
+    } else if (scan == scanQuotedSse2) {
+        scanName = QStringLiteral("SSE2");
+    }
+    if (find == findRowStartsAvx2) {
+        findName = QStringLiteral("AVX2");
+    } else if (find == findRowStartsSse2) {
+        findName = QStringLiteral("SSE2");
+    }
+#else
+    Q_UNUSED(scan)
+    Q_UNUSED(find)
+#endif
+    return scanName + QLatin1Char('/') + findName;
+}
@@ -0,0 +1,72 @@
+#ifndef ROWINDEXER_H
+#define ROWINDEXER_H
+
+#include <QVector>
+#include <QString>
+#include "codeunit.h"
+
+/**
+ * @brief 单个数据块在两种引号状态假设下的扫描结果
+ *
+ * 块起点是否处于引号内只有扫描完前面所有块才能确定，因此同时记录两种假设下的行起始，
+ * 由调用方按文件顺序做一次前缀传递，选出正确的一组。
+ */
+struct ChunkScanResult {
+    QVector<qint64> rowStartsIfOutside; // 假设块起点在引号外时的行起始偏移
+    QVector<qint64> rowStartsIfInside;  // 假设块起点在引号内时的行起始偏移
+    bool togglesQuoteState = false;     // 块内引号个数为奇数，扫描结束时引号状态翻转
+
+    void clear();
+};
+
+/**
+ * @class RowIndexer
+ * @brief 行索引扫描引擎，在内存映射的文件数据中查找行边界
+ *
+ * 按运行时检测到的指令集选择AVX2/SSE2向量化实现，不支持时退回标量实现。
+ * 引号区域由引号位掩码的前缀异或一次算出（支持时用PCLMUL无进位乘法），不逐个处理引号。
+ * 各实现的输出完全一致。UTF-16文件按对齐的码元用标量实现扫描，偏移仍以字节为单位。
+ */
+class RowIndexer
+{
+public:
+    /**
+     * @brief 查找数据块中所有换行符，记录下一行的起始位置
+     * @param data 数据块起始地址
+     * @param size 数据块字节数
+     * @param baseOffset 数据块在文件中的偏移，追加的位置都会加上该偏移
+     * @param rowStarts 输出：每个'\n'之后一个字节的文件偏移，按升序追加
+     * @param unit 码元宽度，UTF-16时data和size须按码元对齐
+     */
+    static void findRowStarts(const char *data, qint64 size, qint64 baseOffset, QVector<qint64> &rowStarts,
+                              CodeUnit unit = CodeUnit::Byte);
+
+    /**
+     * @brief 扫描一个数据块，同时给出块起点在引号外/引号内两种假设下的行边界
+     *
+     * 引号内的换行符不是行边界。两种假设下的行边界恰好互补：
+     * 换行符之前块内引号个数为偶数时属于"引号外"一组，为奇数时属于"引号内"一组。
+     * @param data 数据块起始地址
+     * @param size 数据块字节数
+     * @param baseOffset 数据块在文件中的偏移
+     * @param result 输出：追加两组行起始偏移并设置引号状态翻转标记
+     * @param unit 码元宽度
+     */
+    static void scanChunk(const char *data, qint64 size, qint64 baseOffset, ChunkScanResult &result,
+                          CodeUnit unit = CodeUnit::Byte);
+
+    /**
+     * @brief 按已知的引号状态顺序扫描数据块，只输出真正的记录起始位置
+     * @param inQuotes 输入为块起点的引号状态，返回时更新为块末尾的引号状态
+     * @param unit 码元宽度
+     */
+    static void findRecordStarts(const char *data, qint64 size, qint64 baseOffset, bool &inQuotes, QVector<qint64> &rowStarts,
+                                 CodeUnit unit = CodeUnit::Byte);
+
+    /**
+     * @brief 当前选用的扫描实现名称，格式为"带引号扫描/换行扫描"，如"AVX2+PCLMUL/AVX2"、"SSE2/AVX2"
+     */
+    static QString implementationName();
+};
+
+#endif // ROWINDEXER_H
@@ -0,0 +1,219 @@
+#include "rowwindow.h"
+
+RowWindow::RowWindow()
+    : m_ring(4)
+    , m_head(0)
+    , m_count(0)
+    , m_size(0)
+    , m_lastHit(0)
+{
+}
+
+void RowWindow::clear()
+{
+    for (int i = 0; i < m_count; ++i) {
+        segment(i) = Segment();
+    }
+    m_head = 0;
+    m_count = 0;
+    m_size = 0;
+    m_lastHit = 0;
+}
+
+int RowWindow::size() const
+{
+    return m_size;
+}
+
+bool RowWindow::isEmpty() const
+{
+    return m_size == 0;
+}
+
+RowWindow::Segment &RowWindow::segment(int i)
+{
+    return m_ring[(m_head + i) & (m_ring.size() - 1)];
+}
+
+const RowWindow::Segment &RowWindow::segment(int i) const
+{
+    return m_ring.at((m_head + i) & (m_ring.size() - 1));
+}
+
+void RowWindow::reserve(int count)
+{
+    if (count <= m_ring.size()) {
+        return;
+    }
+    int capacity = m_ring.size();
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    QVector<Segment> ring(capacity);
+    for (int i = 0; i < m_count; ++i) {
+        ring[i] = segment(i);
+    }
+    m_ring = ring;
+    m_head = 0;
+}
+
+qint64 RowWindow::frontPosition() const
+{
+    return m_count > 0 ? segment(0).position : 0;
+}
+
+void RowWindow::append(const QSharedPointer<const RowBlock> &block, int first, int count)
+{
+    if (!block || count <= 0) {
+        return;
+    }
+    m_size += count;
+    if (m_count > 0) {
+        // 与末尾一段在同一块中相接时直接延长
+        Segment &last = segment(m_count - 1);
+        if (last.block == block && last.firstRow + last.rowCount == first) {
+            last.rowCount += count;
+            return;
+        }
+    }
+    reserve(m_count + 1);
+    Segment &added = segment(m_count);
+    added.block = block;
+    added.firstRow = first;
+    added.rowCount = count;
+    added.position = m_count > 0 ? segment(m_count - 1).position + segment(m_count - 1).rowCount : 0;
+    m_count++;
+}
+
+void RowWindow::prepend(const QSharedPointer<const RowBlock> &block, int first, int count)
+{
+    if (!block || count <= 0) {
+        return;
+    }
+    m_size += count;
+    if (m_count > 0) {
+        Segment &front = segment(0);
+        if (front.block == block && first + count == front.firstRow) {
+            front.firstRow = first;
+            front.rowCount += count;
+            front.position -= count;
+            return;
+        }
+    }
+    reserve(m_count + 1);
+    const qint64 position = frontPosition() - count;
+    m_head = (m_head - 1) & (m_ring.size() - 1);
+    Segment &added = segment(0);
+    added.block = block;
+    added.firstRow = first;
+    added.rowCount = count;
+    added.position = position;
+    m_count++;
+    m_lastHit++;
+}
+
+void RowWindow::append(const RowWindow &rows, int first, int count)
+{
+    first = qMax(0, first);
+    const int end = qMin(first + count, rows.m_size);
+    int segmentStart = 0;
+    for (int i = 0; i < rows.m_count && segmentStart < end; ++i) {
+        const Segment &source = rows.segment(i);
+        const int low = qMax(first, segmentStart);
+        const int high = qMin(end, segmentStart + source.rowCount);
+        if (low < high) {
+            append(source.block, source.firstRow + low - segmentStart, high - low);
+        }
+        segmentStart += source.rowCount;
+    }
+}
+
+void RowWindow::prepend(const RowWindow &rows, int first, int count)
+{
+    // 从后向前逐段加到开头，保持原有顺序
+    first = qMax(0, first);
+    const int end = qMin(first + count, rows.m_size);
+    int segmentEnd = rows.m_size;
+    for (int i = rows.m_count - 1; i >= 0 && segmentEnd > first; --i) {
+        const Segment &source = rows.segment(i);
+        const int segmentStart = segmentEnd - source.rowCount;
+        const int low = qMax(first, segmentStart);
+        const int high = qMin(end, segmentEnd);
+        if (low < high) {
+            prepend(source.block, source.firstRow + low - segmentStart, high - low);
+        }
+        segmentEnd = segmentStart;
+    }
+}
+
+void RowWindow::removeFirst(int rows)
+{
+    rows = qMin(rows, m_size);
+    while (rows > 0) {
+        Segment &first = segment(0);
+        const int removed = qMin(rows, first.rowCount);
+        first.firstRow += removed;
+        first.rowCount -= removed;
+        first.position += removed;
+        rows -= removed;
+        m_size -= removed;
+        if (first.rowCount == 0) {
+            first = Segment();
+            m_head = (m_head + 1) & (m_ring.size() - 1);
+            m_count--;
+            m_lastHit = qMax(0, m_lastHit - 1);
+        }
+    }
+}
+
+void RowWindow::removeLast(int rows)
+{
+    rows = qMin(rows, m_size);
+    while (rows > 0) {
+        Segment &last = segment(m_count - 1);
+        const int removed = qMin(rows, last.rowCount);
+        last.rowCount -= removed;
+        rows -= removed;
+        m_size -= removed;
+        if (last.rowCount == 0) {
+            last = Segment();
+            m_count--;
+        }
+    }
+    m_lastHit = qMin(m_lastHit, qMax(0, m_count - 1));
+}
+
+const RowBlock &RowWindow::blockAt(int index, int *row) const
+{
+    const qint64 position = frontPosition() + index;
+    int hit = qMin(m_lastHit, m_count - 1);
+    const Segment *candidate = &segment(hit);
+    if (position < candidate->position || position >= candidate->position + candidate->rowCount) {
+        // 二分查找最后一个起点不大于position的块
+        int low = 0;
+        int high = m_count - 1;
+        while (low < high) {
+            const int mid = (low + high + 1) / 2;
+            if (segment(mid).position <= position) {
+                low = mid;
+            } else {
+                high = mid - 1;
+            }
+        }
+        hit = low;
+        candidate = &segment(hit);
+        m_lastHit = hit;
+    }
+    *row = candidate->firstRow + int(position - candidate->position);
+    return *candidate->block;
+}
+
+qint64 RowWindow::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for (int i = 0; i < m_count; ++i) {
+        const Segment &part = segment(i);
+        bytes += part.block->memoryUsage() * part.rowCount / qMax(1, part.block->rowCount());
+    }
+    return bytes;
+}
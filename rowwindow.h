@@ -0,0 +1,77 @@
+#ifndef ROWWINDOW_H
+#define ROWWINDOW_H
+
+#include <QVector>
+#include <QSharedPointer>
+#include "rowblock.h"
+
+/**
+ * @class RowWindow
+ * @brief 表格模型中连续数据行的窗口，由若干行块首尾相接组成
+ *
+ * 行块存放在环形缓冲区中，每个元素是一个共享的只读行块和其中仍在窗口内的行区间。
+ * 在任一端加入或移除一个块都是O(1)，裁剪行只修改端点块的行区间，不移动其他元素，也不复制行。
+ * 读取结果也以RowWindow的形式跨线程传递，它只引用缓存中的块，表格模型接收时只复制块引用。
+ * 每个块记录它在一个单调的逻辑坐标中的起点，按行号查找时对块做二分查找，并缓存上次命中的块，
+ * 顺序访问（绘制一屏）时通常直接命中。
+ */
+class RowWindow
+{
+public:
+    RowWindow();
+
+    void clear();
+    int size() const; // 窗口中的行数
+    bool isEmpty() const;
+
+    /**
+     * @brief 在末尾/开头加入块中的连续若干行，只增加块的引用，不复制数据
+     */
+    void append(const QSharedPointer<const RowBlock> &block, int first, int count);
+    void prepend(const QSharedPointer<const RowBlock> &block, int first, int count);
+
+    /**
+     * @brief 在末尾/开头加入另一个窗口中的[first, first + count)行
+     */
+    void append(const RowWindow &rows, int first, int count);
+    void prepend(const RowWindow &rows, int first, int count);
+
+    /**
+     * @brief 从开头/末尾移除若干行，整块移出时释放对该块的引用
+     */
+    void removeFirst(int rows);
+    void removeLast(int rows);
+
+    /**
+     * @brief 第index行所在的块和块内行号
+     * @param index 窗口中的行号（0 ~ size()-1）
+     * @param row 输出：块内行号
+     */
+    const RowBlock &blockAt(int index, int *row) const;
+
+    /**
+     * @brief 窗口中的行占用的字节数，按各块中在窗口内的行数比例折算
+     */
+    qint64 memoryUsage() const;
+
+private:
+    struct Segment {
+        QSharedPointer<const RowBlock> block;
+        int firstRow = 0;    // 块中第一个在窗口内的行
+        int rowCount = 0;    // 块中在窗口内的行数
+        qint64 position = 0; // 第一行在逻辑坐标中的位置
+    };
+
+    QVector<Segment> m_ring; // 容量为2的幂
+    int m_head;              // 第一个块在m_ring中的下标
+    int m_count;             // 块数
+    int m_size;              // 行数
+    mutable int m_lastHit;   // 上次查找命中的块（相对m_head的序号）
+
+    Segment &segment(int i); // 第i个块（相对m_head）
+    const Segment &segment(int i) const;
+    void reserve(int count); // 容量不足时加倍，按顺序重新排列
+    qint64 frontPosition() const; // 窗口第一行的逻辑位置
+};
+
+#endif // ROWWINDOW_H
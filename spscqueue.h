@@ -0,0 +1,66 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QtGlobal>
+#include <QAtomicInteger>
+#include <utility>
+
+/**
+ * @class SpscQueue
+ * @brief 单生产者单消费者的无锁环形队列，容量固定
+ *
+ * 只允许一个线程push、另一个线程pop。两端各自只写自己的下标，通过acquire/release
+ * 读取对方的下标，不加锁，生产者和消费者互不阻塞。队列满时push返回false，由调用方决定等待还是放弃。
+ * 下标是自由递增的32位计数，按容量取模得到槽位，回绕时差值仍然正确。
+ */
+template <typename T, int Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "容量必须是2的幂");
+
+public:
+    SpscQueue()
+        : m_head(0)
+        , m_tail(0)
+    {
+    }
+
+    /**
+     * @brief 放入一个元素（只在生产者线程调用）
+     * @return 队列已满时返回false
+     */
+    bool push(const T &value)
+    {
+        const quint32 tail = m_tail.loadRelaxed();
+        if (tail - m_head.loadAcquire() == quint32(Capacity)) {
+            return false;
+        }
+        m_slots[tail & (Capacity - 1)] = value;
+        m_tail.storeRelease(tail + 1);
+        return true;
+    }
+
+    /**
+     * @brief 取出一个元素（只在消费者线程调用），槽位随即清空，不再持有元素中的引用
+     * @return 队列为空时返回false
+     */
+    bool pop(T *value)
+    {
+        const quint32 head = m_head.loadRelaxed();
+        if (head == m_tail.loadAcquire()) {
+            return false;
+        }
+        T &slot = m_slots[head & (Capacity - 1)];
+        *value = std::move(slot);
+        slot = T();
+        m_head.storeRelease(head + 1);
+        return true;
+    }
+
+private:
+    T m_slots[Capacity]; // 两个线程同时访问的只是不同的槽位
+    QAtomicInteger<quint32> m_head; // 下一个要取出的位置，只由消费者写
+    QAtomicInteger<quint32> m_tail; // 下一个要放入的位置，只由生产者写
+};
+
+#endif // SPSCQUEUE_H
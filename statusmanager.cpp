@@ -94,6 +94,33 @@ void StatusManager::updateStatusBar(const QString &additionalInfo)
         message += performanceInfo;
     }
     
+    // 添加队列统计信息
+    QString queueInfo = formatQueueInfo();
+    if (!queueInfo.isEmpty()) {
+        if (!message.isEmpty()) {
+            message += " ";
+        }
+        message += queueInfo;
+    }
+    
+    // 添加行块缓存统计信息
+    QString cacheInfo = formatCacheInfo();
+    if (!cacheInfo.isEmpty()) {
+        if (!message.isEmpty()) {
+            message += " ";
+        }
+        message += cacheInfo;
+    }
+    
+    // 添加绘制耗时
+    QString frameInfo = formatFrameInfo();
+    if (!frameInfo.isEmpty()) {
+        if (!message.isEmpty()) {
+            message += " ";
+        }
+        message += frameInfo;
+    }
+    
     // 添加额外信息
     if (!additionalInfo.isEmpty()) {
         if (!message.isEmpty()) {
@@ -137,9 +164,27 @@ void StatusManager::mergePerformanceData(const QString &source, const QMap<QStri
     updateStatusBar();
 }
 
+void StatusManager::setQueueStats(const QVector<ReadQueueStats> &stats)
+{
+    m_queueStats = stats;
+}
+
+void StatusManager::setCacheStats(const BlockCacheStats &stats)
+{
+    m_cacheStats = stats;
+}
+
+void StatusManager::setFrameStats(const GridFrameStats &stats)
+{
+    m_frameStats = stats;
+}
+
 void StatusManager::clearPerformanceData()
 {
     m_performanceData.clear();
+    m_queueStats.clear();
+    m_cacheStats = BlockCacheStats();
+    m_frameStats = GridFrameStats();
     m_timingOperations.clear();
     m_isTimerActive = false;
     m_timer.invalidate();
@@ -179,3 +224,58 @@ QString StatusManager::formatPerformanceInfo() const
     
     return timingInfo;
 }
+
+QString StatusManager::formatQueueInfo() const
+{
+    if (m_queueStats.isEmpty()) {
+        return "";
+    }
+    
+    QString queueInfo = "[读取队列: ";
+    for (int i = 0; i < m_queueStats.size(); ++i) {
+        if (i > 0) {
+            queueInfo += ", ";
+        }
+        const ReadQueueStats &stats = m_queueStats.at(i);
+        queueInfo += QString("%1 %2个/%3ms")
+                         .arg(ReadScheduler::priorityName(static_cast<ReadPriority>(i)))
+                         .arg(stats.depth)
+                         .arg(stats.lastWaitMs);
+    }
+    queueInfo += "]";
+    
+    return queueInfo;
+}
+
+QString StatusManager::formatCacheInfo() const
+{
+    const qint64 lookups = m_cacheStats.hotHits + m_cacheStats.coldHits + m_cacheStats.misses;
+    if (lookups == 0) {
+        return "";
+    }
+    
+    const qint64 mb = 1024 * 1024;
+    return QString("[行块缓存: 热层命中%1, 冷层命中%2, 未命中%3, 热层%4/%5MB, 冷层%6/%7MB(压缩前%8MB)]")
+        .arg(m_cacheStats.hotHits)
+        .arg(m_cacheStats.coldHits)
+        .arg(m_cacheStats.misses)
+        .arg(m_cacheStats.hotBytes / mb)
+        .arg(m_cacheStats.hotBudget / mb)
+        .arg(m_cacheStats.coldBytes / mb)
+        .arg(m_cacheStats.coldBudget / mb)
+        .arg(m_cacheStats.coldRawBytes / mb);
+}
+
+QString StatusManager::formatFrameInfo() const
+{
+    if (m_frameStats.frames == 0) {
+        return "";
+    }
+    
+    // 60帧每秒要求每帧在16ms内完成
+    return QString("[绘制: 最近%1ms/%2格, 最慢%3ms/%4格]")
+        .arg(m_frameStats.lastFrameNs / 1e6, 0, 'f', 2)
+        .arg(m_frameStats.lastCells)
+        .arg(m_frameStats.slowestFrameNs / 1e6, 0, 'f', 2)
+        .arg(m_frameStats.slowestCells);
+}
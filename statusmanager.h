@@ -7,6 +7,9 @@
 #include <QElapsedTimer>
 #include <QLabel>
 #include <QStatusBar>
+#include "readscheduler.h"
+#include "rowblockcache.h"
+#include "csvgridview.h"
 
 // 调试宏定义，可通过注释掉这行来关闭所有调试信息
 #define STATUS_DEBUG_PRINT(msg) qDebug() << "[STATUS_MANAGER]" << msg
@@ -58,6 +61,22 @@ public:
      */
     void mergePerformanceData(const QString &source, const QMap<QString, qint64> &performanceData);
     
+    /**
+     * @brief 更新读取调度器各优先级的队列深度和等待时间，下次刷新状态栏时显示
+     * @param stats 按ReadPriority顺序的统计
+     */
+    void setQueueStats(const QVector<ReadQueueStats> &stats);
+    
+    /**
+     * @brief 更新行块缓存的命中和占用统计，下次刷新状态栏时显示
+     */
+    void setCacheStats(const BlockCacheStats &stats);
+    
+    /**
+     * @brief 更新表格视图的绘制耗时，下次刷新状态栏时显示
+     */
+    void setFrameStats(const GridFrameStats &stats);
+    
     /**
      * @brief 清除所有性能数据
      */
@@ -84,12 +103,33 @@ private:
     QMap<QString, qint64> m_timingOperations; // 存储每个操作的开始时间戳
     bool m_isTimerActive; // 计时器是否激活
     QString m_fileInfo;
+    QVector<ReadQueueStats> m_queueStats; // 读取调度器的队列统计
+    BlockCacheStats m_cacheStats; // 行块缓存统计
+    GridFrameStats m_frameStats; // 表格视图的绘制耗时
 
     /**
      * @brief 格式化性能统计信息
      * @return 格式化后的性能统计字符串
      */
     QString formatPerformanceInfo() const;
+    
+    /**
+     * @brief 格式化队列统计信息
+     * @return 各优先级"排队数/最近等待时间"的字符串
+     */
+    QString formatQueueInfo() const;
+    
+    /**
+     * @brief 格式化行块缓存统计信息
+     * @return 两层命中、未命中和各层"占用/预算"的字符串，还没有读取时为空
+     */
+    QString formatCacheInfo() const;
+    
+    /**
+     * @brief 格式化绘制耗时
+     * @return 最近一帧和最慢一帧的"耗时/单元格数"，还没有绘制时为空
+     */
+    QString formatFrameInfo() const;
 };
 
 #endif // STATUSMANAGER_H
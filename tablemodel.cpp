@@ -3,12 +3,105 @@
 
 TableModel::TableModel(QObject *parent)
     : QAbstractTableModel(parent)
+    , m_cellCache(CellCacheSize)
     , m_fullDataStartRow(0)
     , m_visibleStartRow(0)
     , m_visibleRows(0)
+    , m_maxDataRows(0)
+    , m_scrollDirection(0)
+    , m_updateDepth(0)
+    , m_resetPending(false)
+    , m_changedFirst(-1)
+    , m_changedLast(-1)
+    , m_headerChanged(false)
 {
 }
 
+QString TableModel::cellText(int actualRow, int actualColumn) const
+{
+    const QPair<qint64, int> key(m_fullDataStartRow + actualRow, actualColumn);
+    if (const QString *cached = m_cellCache.object(key)) {
+        return *cached;
+    }
+    int row = 0;
+    const RowBlock &block = m_fullData.blockAt(actualRow, &row);
+    m_decoder.setEncoding(block.encoding());
+    const QString text = block.field(row, actualColumn, m_decoder);
+    m_cellCache.insert(key, new QString(text));
+    return text;
+}
+
+void TableModel::clearCellCache()
+{
+    m_cellCache.clear();
+}
+
+void TableModel::beginUpdate()
+{
+    m_updateDepth++;
+}
+
+void TableModel::endUpdate()
+{
+    if (m_updateDepth == 0 || --m_updateDepth > 0) {
+        return;
+    }
+    const int first = m_changedFirst;
+    const int last = m_changedLast;
+    const bool header = m_headerChanged;
+    m_changedFirst = -1;
+    m_changedLast = -1;
+    m_headerChanged = false;
+    if (m_resetPending) {
+        // 重置已包含所有变化
+        m_resetPending = false;
+        endResetModel();
+        return;
+    }
+    notifyRowsChanged(first, last, header);
+}
+
+void TableModel::beginDataReset()
+{
+    if (m_updateDepth == 0) {
+        beginResetModel();
+    } else if (!m_resetPending) {
+        beginResetModel();
+        m_resetPending = true;
+    }
+}
+
+void TableModel::endDataReset()
+{
+    if (m_updateDepth == 0) {
+        endResetModel();
+    }
+}
+
+void TableModel::notifyRowsChanged(int first, int last, bool header)
+{
+    first = qMax(first, 0);
+    last = qMin(last, int(m_visibleRows) - 1);
+    if (m_updateDepth > 0) {
+        if (m_resetPending) {
+            return;
+        }
+        if (first <= last) {
+            m_changedFirst = m_changedFirst < 0 ? first : qMin(m_changedFirst, first);
+            m_changedLast = qMax(m_changedLast, last);
+        }
+        m_headerChanged = m_headerChanged || header;
+        return;
+    }
+    if (first <= last && columnCount() > 0) {
+        emit dataChanged(index(first, 0), index(last, columnCount() - 1));
+    }
+    if (header && m_visibleRows > 0) {
+        // 告诉视图：垂直表头的数据变了，需要重新获取 headerData
+        emit headerDataChanged(Qt::Vertical, 0, m_visibleRows - 1);
+    }
+}
+
 int TableModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid())
@@ -37,50 +130,67 @@ QVariant TableModel::data(const QModelIndex &index, int role) const
         return QVariant();
     
     // 确定实际的列索引
-    int actualColumn = index.column();
-    if (!m_selectedColumnIndexes.isEmpty() && actualColumn < m_selectedColumnIndexes.size()) {
-        actualColumn = m_selectedColumnIndexes[actualColumn];
-    }
+    const int actualColumn = sourceColumn(index.column());
     
     // 检查该行是否有足够的列数据
-    const QStringList& rowData = m_fullData.at(actualRow);
-    if (actualColumn >= rowData.size()) {
-        return QVariant(); // 如果该行没有足够的列数据，则返回空
+    int row = 0;
+    if (!m_fullData.blockAt(actualRow, &row).hasField(row, actualColumn)) {
+        return QVariant(); // 该行没有足够的列数据，或读取时该列不在列投影中，返回空
     }
     
     if (role == Qt::DisplayRole) {
-        return rowData.at(actualColumn);
+        // 只有视图真正需要显示时才解码
+        return cellText(actualRow, actualColumn);
     }
     else if (role == Qt::BackgroundRole) {
-        // 计算全局行号（文件中的实际行号）
-        int globalRow = m_fullDataStartRow + actualRow + 1; // +1 是因为行号从1开始
-        
-        // 检查是否是高亮行或高亮列
-        if (m_highlightedRows.contains(globalRow) && m_highlightedColumns.contains(actualColumn)) {
-            // 同时是高亮行和列，使用更深的颜色
-            return QColor(255, 215, 0, 200); // 金色半透明
-        }
-        else if (m_highlightedRows.contains(globalRow)) {
-            // 高亮行，使用黄色
-            return QColor(255, 255, 153, 150); // 浅黄色半透明
-        }
-        else if (m_highlightedColumns.contains(actualColumn)) {
-            // 高亮列，使用浅绿色
-            return QColor(153, 255, 153, 150); // 浅绿色半透明
+        // 计算全局行号（文件中的实际行号），+1 是因为行号从1开始
+        const QColor color = highlightColor(m_fullDataStartRow + actualRow + 1, actualColumn);
+        if (color.isValid()) {
+            return color;
         }
     }
     
     return QVariant();
 }
 
+int TableModel::sourceColumn(int column) const
+{
+    if (!m_selectedColumnIndexes.isEmpty() && column < m_selectedColumnIndexes.size()) {
+        return m_selectedColumnIndexes[column];
+    }
+    return column;
+}
+
+QColor TableModel::highlightColor(qint64 globalRow, int sourceColumn) const
+{
+    // 检查是否是高亮行或高亮列
+    const bool rowHighlighted = m_highlightedRows.contains(int(globalRow));
+    const bool columnHighlighted = m_highlightedColumns.contains(sourceColumn);
+    if (rowHighlighted && columnHighlighted) {
+        // 同时是高亮行和列，使用更深的颜色
+        return QColor(255, 215, 0, 200); // 金色半透明
+    }
+    else if (rowHighlighted) {
+        // 高亮行，使用黄色
+        return QColor(255, 255, 153, 150); // 浅黄色半透明
+    }
+    else if (columnHighlighted) {
+        // 高亮列，使用浅绿色
+        return QColor(153, 255, 153, 150); // 浅绿色半透明
+    }
+    return QColor();
+}
+
+const RowWindow &TableModel::getFullData() const
+{
+    return m_fullData;
+}
+
 QVariant TableModel::headerData(int section, Qt::Orientation orientation, int role) const
 {
     if (orientation == Qt::Horizontal) {
         // 确定实际的列索引
-        int actualSection = section;
-        if (!m_selectedColumnIndexes.isEmpty() && section < m_selectedColumnIndexes.size()) {
-            actualSection = m_selectedColumnIndexes[section];
-        }
+        const int actualSection = sourceColumn(section);
         
         if (role == Qt::DisplayRole) {
             if (actualSection < m_headers.size()) {
@@ -108,6 +218,7 @@ void TableModel::setHeaders(const QVector<QString> &headers)
     beginResetModel();
     m_headers = headers;
     m_fullData.clear();
+    clearCellCache();
     m_fullDataStartRow = 0;
     m_visibleStartRow = 0;
     m_visibleRows = 0;
@@ -134,6 +245,7 @@ void TableModel::clear()
     beginResetModel();
     m_headers.clear();
     m_fullData.clear();
+    clearCellCache();
     m_fullDataStartRow = 0;
     m_visibleStartRow = 0;
     m_visibleRows = 0;
@@ -141,39 +253,23 @@ void TableModel::clear()
     endResetModel();
 }
 
-// 待修改
-void TableModel::setDataWindow(const QVector<QStringList> &data, qint64 startRow)
-{
-    qDebug() << "设置数据窗口: 数据行数=" << data.size() << ", 起始行=" << startRow;
-    
-    beginResetModel();
-    m_fullData = data;
-    m_fullDataStartRow = startRow;
-    m_visibleStartRow = 0;
-    // 假设传入的data大小就是3倍的可视行数
-    m_visibleRows = data.size() / 3;
-    endResetModel();
-    
-    qDebug() << "数据窗口设置完成: 完整数据行数=" << m_fullData.size() 
-             << ", 可视行数=" << m_visibleRows << ", 起始行=" << m_fullDataStartRow;
-}
-
 qint64 TableModel::getCurrentWindowStartRow() const
 {
     return m_fullDataStartRow + m_visibleStartRow;
 }
 
 // 得到请求的可视窗口数据后初始化模型数据
-void TableModel::setModelData(const QVector<QStringList> &data, qint64 startRow)
+void TableModel::setModelData(const RowWindow &data, qint64 startRow)
 {
     qDebug() << "设置完整数据: 数据行数=" << data.size() << ", 起始行=" << startRow;
     
-    beginResetModel();
+    beginDataReset();
     m_fullData = data;
+    clearCellCache();
     m_fullDataStartRow = startRow;
     m_visibleStartRow = 0;
     m_visibleRows = data.size();
-    endResetModel();
+    endDataReset();
     
     qDebug() << "完整数据设置完成: 完整数据行数=" << m_fullData.size() 
              << ", 可视行数=" << m_visibleRows << ", 起始行=" << m_fullDataStartRow;
@@ -181,17 +277,16 @@ void TableModel::setModelData(const QVector<QStringList> &data, qint64 startRow)
 
 void TableModel::adjustVisibleWindow(qint64 relativeStartRow)
 {
+    const qint64 previousStartRow = m_visibleStartRow;
     if(m_visibleStartRow + relativeStartRow < 0)
         m_visibleStartRow = 0;
     else
         m_visibleStartRow += relativeStartRow;
 
-    emit dataChanged(
-        index(0, 0),
-        index(m_visibleRows - 1, columnCount() - 1)
-        );
-    // 告诉视图：垂直表头的数据变了，需要重新获取 headerData
-    emit headerDataChanged(Qt::Vertical, 0, m_visibleRows - 1);
+    // 内容整体平移：视图平移已绘制的部分，只重绘新露出的行和行号
+    if (m_visibleStartRow != previousStartRow) {
+        emit visibleWindowMoved(int(m_visibleStartRow - previousStartRow));
+    }
 
     //qDebug() << "调整可视窗口:"<<"变更行数"<< relativeStartRow <<"新的可视起始行=" << m_visibleStartRow+m_fullDataStartRow<<"模型起="<<m_fullDataStartRow <<"模型终="<<m_fullDataStartRow + getFullDataSize();
     //qDebug() << "m_visibleRows-1 = " <<m_visibleRows <<"columnCount()"<<columnCount();
@@ -214,82 +309,93 @@ int TableModel::getFullDataSize() const
 
 void TableModel::clearDataOnly()
 {
-    beginResetModel();
+    beginDataReset();
     m_fullData.clear();
+    clearCellCache();
     m_fullDataStartRow = 0;
     m_visibleStartRow = 0;
     m_visibleRows = 0;
-    endResetModel();
+    endDataReset();
 }
 
 // 预加载数据整合方法的实现
-void TableModel::prependPreloadedData(const QVector<QStringList> &data)
+void TableModel::prependPreloadedData(const RowWindow &data, int first, int count)
 {
-    if (data.isEmpty()) return;
+    count = qMin(count, data.size() - first);
+    if (count <= 0) return;
     
-    qDebug() << "向前预加载数据: 数据行数=" << data.size();
+    qDebug() << "向前预加载数据: 数据行数=" << count;
     
-    // 将新数据添加到前面
-    for (int i = data.size() - 1; i >= 0; --i) {
-        m_fullData.prepend(data[i]);
-    }
+    // 将新数据添加到前面（只加入块引用）
+    m_fullData.prepend(data, first, count);
     
-    // 更新起始行号
-    m_fullDataStartRow -= data.size();
-    m_visibleStartRow += data.size();
+    // 更新起始行号（解码缓存按全局行号索引，无需清空）
+    m_fullDataStartRow -= count;
+    m_visibleStartRow += count;
     
-    // 维持三倍窗口大小
-    maintainTripleWindowSize();
+    // 超出上限时裁剪
+    trimDataWindow();
     
     qDebug() << "向前预加载完成: 完整数据行数=" << m_fullData.size() 
              << ", 起始行=" << m_fullDataStartRow;
 }
 
-void TableModel::appendPreloadedData(const QVector<QStringList> &data)
+void TableModel::appendPreloadedData(const RowWindow &data, int first, int count)
 {
-    if (data.isEmpty()) return;
+    count = qMin(count, data.size() - first);
+    if (count <= 0) return;
     
-    qDebug() << "向后预加载数据: 数据行数=" << data.size();
+    qDebug() << "向后预加载数据: 数据行数=" << count;
     
-    // 将新数据添加到后面
-    for (const QStringList& row : data) {
-        m_fullData.append(row);
-    }
+    // 将新数据添加到后面（只加入块引用）
+    const int previousSize = m_fullData.size();
+    m_fullData.append(data, first, count);
+    // 可视区域中此前还没有数据的行（显示为空）需要刷新
+    notifyRowsChanged(int(previousSize - m_visibleStartRow), int(m_fullData.size() - m_visibleStartRow) - 1, false);
     
-    // 维持三倍窗口大小
-    maintainTripleWindowSize();
+    // 超出上限时裁剪
+    trimDataWindow();
     
     qDebug() << "向后预加载完成: 完整数据行数=" << m_fullData.size() 
              << ", 起始行=" << m_fullDataStartRow;
 }
 
-bool TableModel::canPrependData(qint64 requestedStartRow) const
-{
-    // 检查是否可以向前预加载（即起始行号是否可以更小）
-    return requestedStartRow < m_fullDataStartRow;
-}
-
-bool TableModel::canAppendData(qint64 requestedEndRow) const
+bool TableModel::containsRows(qint64 firstRow, qint64 count) const
 {
-    // 检查是否可以向后预加载（即结束行号是否可以更大）
-    return (m_fullDataStartRow + m_fullData.size() - 1) < requestedEndRow;
+    return firstRow >= m_fullDataStartRow && firstRow + count <= m_fullDataStartRow + m_fullData.size();
 }
 
-void TableModel::maintainTripleWindowSize()
+void TableModel::trimDataWindow()
 {
-    // 确保数据窗口大小维持在三倍于可视行数
     if (m_visibleRows <= 0) return;
     
-    int targetSize = m_visibleRows * 3;
-    if (m_fullData.size() > targetSize) {
-        // 如果数据过多，需要裁剪
-        int excess = m_fullData.size() - targetSize;
-        // 优先保持当前可视窗口的数据，裁剪两端的数据
-        // 这里简化处理，直接从前面裁剪
-        for (int i = 0; i < excess; ++i) {
-            m_fullData.removeFirst();
-            m_fullDataStartRow++;
-        }
+    const int targetSize = m_maxDataRows > 0 ? m_maxDataRows : int(m_visibleRows * 3);
+    int excess = m_fullData.size() - targetSize;
+    if (excess <= 0) return;
+    
+    // 可视区域前后可以裁剪的行数
+    const int frontSpare = int(m_visibleStartRow);
+    const int backSpare = qMax(0, m_fullData.size() - int(m_visibleStartRow + m_visibleRows));
+    // 先裁剪背离滚动方向的一侧，不够时再裁剪另一侧；静止时裁剪较长的一侧
+    const bool frontFirst = m_scrollDirection > 0 || (m_scrollDirection == 0 && frontSpare >= backSpare);
+    int trimFront = 0;
+    int trimBack = 0;
+    if (frontFirst) {
+        trimFront = qMin(excess, frontSpare);
+        trimBack = qMin(excess - trimFront, backSpare);
+    } else {
+        trimBack = qMin(excess, backSpare);
+        trimFront = qMin(excess - trimBack, frontSpare);
+    }
+    
+    if (trimBack > 0) {
+        m_fullData.removeLast(trimBack);
+    }
+    if (trimFront > 0) {
+        // 可视区域的内容不变，只是它在完整数据中的位置前移
+        m_fullData.removeFirst(trimFront);
+        m_fullDataStartRow += trimFront;
+        m_visibleStartRow -= trimFront;
     }
 }
 
@@ -298,6 +404,16 @@ void TableModel::setVisibleRows(int visibleRows)
     m_visibleRows = visibleRows;
 }
 
+void TableModel::setMaxDataRows(int maxRows)
+{
+    m_maxDataRows = maxRows;
+}
+
+void TableModel::setScrollDirection(int direction)
+{
+    m_scrollDirection = direction;
+}
+
 void TableModel::setSelectedColumns(const QVector<QString>& selectedColumns)
 {
     beginResetModel();
@@ -5,6 +5,10 @@
 #include <QVector>
 #include <QStringList>
 #include <QColor>
+#include <QCache>
+#include <QPair>
+#include "rowwindow.h"
+#include "textdecoder.h"
 
 // 定义DEBUG_PRINT宏，用于调试信息输出
 #ifndef DEBUG_PRINT
@@ -29,7 +33,6 @@ public:
     void addRow(const QStringList &row);
     void addRows(const QVector<QStringList> &rows);
     void clear();
-    void setDataWindow(const QVector<QStringList> &data, qint64 startRow); // 添加设置数据窗口的方法
     qint64 getCurrentWindowStartRow() const;
     void setSelectedColumns(const QVector<QString>& selectedColumns); // 设置选中的列
     const QVector<int>& getSelectedColumnIndexes() const; // 获取选中的列索引
@@ -45,7 +48,7 @@ public:
     void clearColumnHighlighting();
     
     // 双倍窗口新增方法
-    void setModelData(const QVector<QStringList> &data, qint64 startRow); // 设置完整数据（3倍大小）
+    void setModelData(const RowWindow &data, qint64 startRow); // 设置完整数据（3倍大小），只接收块引用，不复制行
     void adjustVisibleWindow(qint64 relativeStartRow); // 调整可视窗口
     qint64 getFullDataStartRow() const; // 获取完整数据的起始行号
     qint64 getVisiableStartRow() const;
@@ -53,16 +56,38 @@ public:
     void clearDataOnly(); // 只清空数据，不清空表头
     
     // 预加载数据整合方法
-    void prependPreloadedData(const QVector<QStringList> &data); // 在前面添加预加载数据
-    void appendPreloadedData(const QVector<QStringList> &data);  // 在后面添加预加载数据
-    bool canPrependData(qint64 requestedStartRow) const; // 检查是否可以向前预加载
-    bool canAppendData(qint64 requestedEndRow) const;   // 检查是否可以向后预加载
-    void maintainTripleWindowSize(); // 维持三倍窗口大小
+    void prependPreloadedData(const RowWindow &data, int first, int count); // 在前面添加预加载数据中的[first, first + count)行
+    void appendPreloadedData(const RowWindow &data, int first, int count);  // 在后面添加预加载数据中的[first, first + count)行
+    bool containsRows(qint64 firstRow, qint64 count) const; // 文件中的[firstRow, firstRow + count)是否都已在完整数据中
+    void trimDataWindow(); // 完整数据超过上限时从背离滚动方向的一侧裁剪，不裁剪可视区域
     void setVisibleRows(int visibleRows); // 设置可视行数
+    void setMaxDataRows(int maxRows); // 设置完整数据最多保留的行数（由预加载器按内存预算给出）
+    void setScrollDirection(int direction); // 设置当前滚动方向（1向下，-1向上，0静止），决定裁剪哪一侧
+
+    // 供CsvGridView直接从行块绘制，不经过data()和QVariant
+    const RowWindow &getFullData() const; // 完整数据，可视区域从getVisiableStartRow()开始
+    int sourceColumn(int column) const; // 显示的第column列对应的原始列号
+    QColor highlightColor(qint64 globalRow, int sourceColumn) const; // 高亮背景色（globalRow从1开始），不高亮时返回无效颜色
+
+    // 批量更新：beginUpdate和endUpdate之间的数据变化合并为一次通知（一次重置，或可视区域中变化的行范围）
+    void beginUpdate();
+    void endUpdate();
+
+signals:
+    void visibleWindowMoved(int rows); // 可视区域在完整数据中移动了rows行（正数向下），内容整体平移，不逐格通知
 
 private:
+    QString cellText(int actualRow, int actualColumn) const; // 解码单元格，结果按全局行号缓存
+    void clearCellCache(); // 数据整体替换时清空解码缓存
+    void beginDataReset(); // 批量更新中只在第一次重置时开始，endUpdate时结束
+    void endDataReset();
+    void notifyRowsChanged(int first, int last, bool header); // 可视区域中的[first, last]行变化，批量更新中合并到endUpdate
+
     QVector<QString> m_headers;  // 表头数据
-    QVector<QStringList> m_fullData; // 完整数据（3倍于可视区域）
+    RowWindow m_fullData; // 完整数据（3倍于可视区域），按块保存原始字节，两端增删不移动其余行
+    mutable TextDecoder m_decoder; // 单元格解码器，编码随数据块设置
+    mutable QCache<QPair<qint64, int>, QString> m_cellCache; // 已解码的单元格，键为(全局行号, 列)
+    static constexpr int CellCacheSize = 8192; // 缓存的单元格数，约为数屏内容
     QVector<int> m_selectedColumnIndexes; // 选中的列索引
     QVector<int> m_newHighlightedColumnIndexes; // 新筛选的列索引（需要高亮）
     QSet<int> m_highlightedRows;    // 高亮的行集合（全局行号）
@@ -70,6 +95,13 @@ private:
     qint64 m_fullDataStartRow; // 完整数据在文件中的起始行号
     qint64 m_visibleStartRow;  // 可视区域在完整数据中的起始行号
     qint64 m_visibleRows;      // 可视区域行数
+    int m_maxDataRows;         // 完整数据最多保留的行数，0表示三倍可视行数
+    int m_scrollDirection;     // 当前滚动方向
+    int m_updateDepth;         // beginUpdate的嵌套层数
+    bool m_resetPending;       // 批量更新中已开始重置，endUpdate时结束
+    int m_changedFirst;        // 批量更新中变化的可视行范围，-1表示没有
+    int m_changedLast;
+    bool m_headerChanged;      // 批量更新中垂直表头（行号）是否变化
 };
 
 #endif // TABLEMODEL_H
\ No newline at end of file
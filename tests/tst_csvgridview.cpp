@@ -0,0 +1,198 @@
+#include <QtTest>
+#include <QHeaderView>
+#include <QWheelEvent>
+#include "csvgridview.h"
+#include "csvreader.h"
+#include "rowblockpool.h"
+#include "tablemodel.h"
+
+namespace {
+
+// 视口正好容纳Rows行×Columns列，CsvViewer可视行数的上限是200行
+constexpr int Rows = 200;
+constexpr int Columns = 100;
+constexpr int RowHeight = 16;
+constexpr int ColumnWidth = 40;
+
+RowWindow makeRows(int count)
+{
+    QSharedPointer<RowBlock> block = RowBlockPool::instance().acquire();
+    block->setEncoding(Encoding::UTF8);
+    QVector<FieldSpan> spans;
+    for (int row = 0; row < count; ++row) {
+        QByteArray record;
+        for (int column = 0; column < Columns; ++column) {
+            if (column > 0) {
+                record.append(',');
+            }
+            record.append(QByteArray::number(row * Columns + column));
+        }
+        block->appendRecord(record.constData(), record.size(), ',', spans);
+    }
+    RowWindow rows;
+    rows.append(block, 0, count);
+    return rows;
+}
+
+// 处理事件直到视图绘制了新的一帧
+bool waitForFrame(const CsvGridView &view, int frames)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (view.frameStats().frames == frames) {
+        if (timer.hasExpired(1000)) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    return true;
+}
+
+void sendPixelWheel(CsvGridView &view, int dy)
+{
+    const QPointF position(10, 10);
+    QWheelEvent event(position, view.viewport()->mapToGlobal(position.toPoint()), QPoint(0, dy), QPoint(),
+                      Qt::NoButton, Qt::NoModifier, Qt::ScrollUpdate, false);
+    QCoreApplication::sendEvent(view.viewport(), &event);
+}
+
+}
+
+class TestCsvGridView : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void paintsEveryVisibleCell();
+    void scrollRepaintsExposedRowsOnly();
+    void pixelScrollCarriesWholeRows();
+    void indexAtFollowsPixelOffset();
+    void fullFrame();
+    void scrollOneRow();
+
+private:
+    TableModel m_model;
+    CsvGridView m_view;
+};
+
+void TestCsvGridView::initTestCase()
+{
+    QVector<QString> headers;
+    for (int column = 0; column < Columns; ++column) {
+        headers.append(QString("c%1").arg(column));
+    }
+    m_model.setHeaders(headers);
+    m_view.setModel(&m_model);
+    m_view.setRowHeight(RowHeight);
+    m_view.horizontalHeader()->setMinimumSectionSize(ColumnWidth);
+    m_view.horizontalHeader()->setDefaultSectionSize(ColumnWidth);
+    m_view.setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_view.setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    m_view.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&m_view));
+
+    const QSize target(Columns * ColumnWidth, Rows * RowHeight);
+    m_view.resize(m_view.size() + target - m_view.viewport()->size());
+    QTRY_COMPARE(m_view.viewport()->size(), target);
+}
+
+void TestCsvGridView::init()
+{
+    // 可视区域之后还有一屏数据，可视区域可以向下移动
+    m_model.setModelData(makeRows(Rows * 2), 1);
+    m_model.setVisibleRows(Rows);
+    m_view.setScrollBounds(false, false);
+    QTest::qWait(50); // 重置引起的重绘先完成
+}
+
+void TestCsvGridView::paintsEveryVisibleCell()
+{
+    m_view.viewport()->repaint();
+    QCOMPARE(m_view.frameStats().lastCells, Rows * Columns);
+}
+
+void TestCsvGridView::scrollRepaintsExposedRowsOnly()
+{
+    int cells = 0;
+    QObject context;
+    connect(&m_view, &CsvGridView::frameRendered, &context, [&cells](const GridFrameStats &stats) {
+        cells += stats.lastCells;
+    });
+
+    // 向下移动一行只露出底部的一行，向上移动一行只露出顶部的一行
+    for (int rows : {1, -1}) {
+        cells = 0;
+        const int frames = m_view.frameStats().frames;
+        m_model.adjustVisibleWindow(rows);
+        QVERIFY(waitForFrame(m_view, frames));
+        QTest::qWait(50);
+        QCOMPARE(cells, Columns);
+    }
+}
+
+void TestCsvGridView::pixelScrollCarriesWholeRows()
+{
+    int scrolled = 0;
+    QObject context;
+    connect(&m_view, &CsvGridView::rowsScrolled, &context, [&scrolled](int rows) {
+        scrolled += rows;
+    });
+
+    // 不足一行的部分保留为像素偏移，满一行时交给外部滚动条
+    sendPixelWheel(m_view, -5);
+    QCOMPARE(m_view.pixelOffset(), 5);
+    QCOMPARE(scrolled, 0);
+    sendPixelWheel(m_view, -RowHeight);
+    QCOMPARE(m_view.pixelOffset(), 5);
+    QCOMPARE(scrolled, 1);
+
+    // 滚动条在顶端时不能越过第一行，在底端时不保留像素偏移
+    m_view.setScrollBounds(true, false);
+    sendPixelWheel(m_view, 2 * RowHeight);
+    QCOMPARE(m_view.pixelOffset(), 0);
+    QCOMPARE(scrolled, 1);
+    m_view.setScrollBounds(false, true);
+    sendPixelWheel(m_view, -5);
+    QCOMPARE(m_view.pixelOffset(), 0);
+    QCOMPARE(scrolled, 1);
+}
+
+void TestCsvGridView::indexAtFollowsPixelOffset()
+{
+    const QPoint cell(2 * ColumnWidth + 1, 3 * RowHeight + 1);
+    QCOMPARE(m_view.indexAt(cell), m_model.index(3, 2));
+
+    sendPixelWheel(m_view, -5);
+    QCOMPARE(m_view.indexAt(cell - QPoint(0, 5)), m_model.index(3, 2));
+    // 底部露出的后续行不在可视行数之内
+    QVERIFY(!m_view.indexAt(QPoint(1, Rows * RowHeight - 1)).isValid());
+}
+
+void TestCsvGridView::fullFrame()
+{
+    // 重绘整个视口：200行×100列
+    QBENCHMARK {
+        m_view.viewport()->repaint();
+    }
+    QCOMPARE(m_view.frameStats().lastCells, Rows * Columns);
+}
+
+void TestCsvGridView::scrollOneRow()
+{
+    // 上下交替移动一行，取视图记录的每帧绘制耗时的平均值
+    constexpr int Frames = 100;
+    qint64 total = 0;
+    for (int i = 0; i < Frames; ++i) {
+        const int frames = m_view.frameStats().frames;
+        m_model.adjustVisibleWindow(i % 2 == 0 ? 1 : -1);
+        QVERIFY(waitForFrame(m_view, frames));
+        total += m_view.frameStats().lastFrameNs;
+    }
+    QTest::setBenchmarkResult(qreal(total) / Frames, QTest::WalltimeNanoseconds);
+}
+
+QTEST_MAIN(TestCsvGridView)
+
+#include "tst_csvgridview.moc"
@@ -0,0 +1,156 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include "csvtokenizer.h"
+
+namespace {
+
+// 切分一条记录并还原各字段的内容（需要时去掉引号）
+QByteArrayList splitRecord(const QByteArray &record, char delimiter = ',')
+{
+    QVector<FieldSpan> spans;
+    CsvTokenizer::tokenize(record.constData(), record.size(), delimiter, spans);
+    QByteArrayList fields;
+    for (const FieldSpan &span : spans) {
+        fields.append(span.needsUnescape ? CsvTokenizer::unescape(record.constData(), span)
+                                         : record.mid(span.offset, span.length));
+    }
+    return fields;
+}
+
+// 逐字节按引号规则切分的参考实现，与任何向量化路径无关
+QByteArrayList referenceSplit(const QByteArray &record, char delimiter = ',')
+{
+    QByteArrayList fields{QByteArray()};
+    bool inQuotes = false;
+    for (int i = 0; i < record.size(); ++i) {
+        const char ch = record.at(i);
+        if (ch == '"') {
+            if (inQuotes && i + 1 < record.size() && record.at(i + 1) == '"') {
+                fields.last().append('"');
+                ++i;
+            } else {
+                inQuotes = !inQuotes;
+            }
+        } else if (ch == delimiter && !inQuotes) {
+            fields.append(QByteArray());
+        } else {
+            fields.last().append(ch);
+        }
+    }
+    return fields;
+}
+
+}
+
+class TestCsvTokenizer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void tokenize_data();
+    void tokenize();
+    void emptyQuotedField();
+    void trimLineEnding();
+    void reusesFieldBuffer();
+    void blockBoundaries();
+    void matchesReference();
+    void implementationName();
+};
+
+void TestCsvTokenizer::tokenize_data()
+{
+    QTest::addColumn<QByteArray>("record");
+    QTest::addColumn<QByteArrayList>("expected");
+
+    QTest::newRow("plain") << QByteArray("a,b,c") << QByteArrayList{"a", "b", "c"};
+    QTest::newRow("empty record") << QByteArray("") << QByteArrayList{""};
+    QTest::newRow("empty fields") << QByteArray(",,") << QByteArrayList{"", "", ""};
+    QTest::newRow("quoted delimiter") << QByteArray("\"a,b\",c") << QByteArrayList{"a,b", "c"};
+    QTest::newRow("escaped quotes") << QByteArray("\"say \"\"hi\"\"\",x") << QByteArrayList{"say \"hi\"", "x"};
+    QTest::newRow("quotes inside unquoted field") << QByteArray("a\"b\"c,d") << QByteArrayList{"abc", "d"};
+    QTest::newRow("quoted line break") << QByteArray("\"line1\nline2\",z") << QByteArrayList{"line1\nline2", "z"};
+    QTest::newRow("quoted CRLF") << QByteArray("\"x\r\ny\",z") << QByteArrayList{"x\r\ny", "z"};
+    QTest::newRow("utf-8") << QByteArray("\xE4\xB8\xAD,\"\xE6\x96\x87,\"") << QByteArrayList{"\xE4\xB8\xAD", "\xE6\x96\x87,"};
+    // 超过一个64字节块，引号区域跨过块边界
+    QTest::newRow("quoted across block") << QByteArray(70, 'x') + ",\"" + QByteArray(60, ',') + "\",y"
+                                         << QByteArrayList{QByteArray(70, 'x'), QByteArray(60, ','), "y"};
+}
+
+void TestCsvTokenizer::tokenize()
+{
+    QFETCH(QByteArray, record);
+    QFETCH(QByteArrayList, expected);
+    QCOMPARE(splitRecord(record), expected);
+}
+
+void TestCsvTokenizer::emptyQuotedField()
+{
+    // "" 是一个空字段，不是一个引号字符
+    const QByteArray record("\"\",\"\"\"\"");
+    QVector<FieldSpan> spans;
+    CsvTokenizer::tokenize(record.constData(), record.size(), ',', spans);
+    QCOMPARE(spans.size(), 2);
+    QCOMPARE(spans[0].length, 0);
+    QVERIFY(!spans[0].needsUnescape);
+    QVERIFY(spans[1].needsUnescape);
+    QCOMPARE(CsvTokenizer::unescape(record.constData(), spans[1]), QByteArray("\""));
+}
+
+void TestCsvTokenizer::trimLineEnding()
+{
+    const QByteArray line(" a,b\r\n");
+    const char *data = line.constData();
+    int size = line.size();
+    CsvTokenizer::trim(data, size);
+    QCOMPARE(QByteArray(data, size), QByteArray("a,b"));
+}
+
+void TestCsvTokenizer::reusesFieldBuffer()
+{
+    // 输出缓冲区在记录之间复用：先清空再追加
+    QVector<FieldSpan> spans;
+    CsvTokenizer::tokenize("a,b,c,d", 7, ',', spans);
+    CsvTokenizer::tokenize("x;y", 3, ';', spans);
+    QCOMPARE(spans.size(), 2);
+    QCOMPARE(spans[1].offset, 2);
+    QCOMPARE(spans[1].length, 1);
+}
+
+void TestCsvTokenizer::blockBoundaries()
+{
+    // 把带引号、转义引号和分隔符的片段依次移过64字节块边界
+    const QByteArray tail("\"a,\"\"b\r\nc\",d,\"\"");
+    for (int prefix = 0; prefix <= 130; ++prefix) {
+        const QByteArray record = QByteArray(prefix, 'x') + tail;
+        QCOMPARE(splitRecord(record), referenceSplit(record));
+    }
+}
+
+void TestCsvTokenizer::matchesReference()
+{
+    // 固定种子的随机记录，结构字符密集，长度跨越多个64字节块
+    static const char alphabet[] = {'a', ',', ',', '\t', '"', '"', ' ', '\n', '\r', '\xC3', '\xA9'};
+    QRandomGenerator random(20240611);
+    for (int round = 0; round < 2000; ++round) {
+        const int length = random.bounded(300);
+        QByteArray record;
+        for (int i = 0; i < length; ++i) {
+            record.append(alphabet[random.bounded(int(sizeof(alphabet)))]);
+        }
+        QCOMPARE(splitRecord(record), referenceSplit(record));
+        QCOMPARE(splitRecord(record, '\t'), referenceSplit(record, '\t'));
+    }
+}
+
+void TestCsvTokenizer::implementationName()
+{
+    if (qEnvironmentVariableIsSet("CSV_FORCE_SCALAR")) {
+        QCOMPARE(CsvTokenizer::implementationName(), QStringLiteral("Scalar"));
+    } else {
+        QVERIFY(!CsvTokenizer::implementationName().isEmpty());
+    }
+}
+
+QTEST_APPLESS_MAIN(TestCsvTokenizer)
+
+#include "tst_csvtokenizer.moc"
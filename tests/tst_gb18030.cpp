@@ -0,0 +1,68 @@
+#include <QtTest>
+#include "gb18030.h"
+
+namespace {
+
+QString fromUnits(std::initializer_list<char16_t> units)
+{
+    return QString::fromUtf16(units.begin(), int(units.size()));
+}
+
+QString decode(const QByteArray &bytes)
+{
+    return Gb18030::toUnicode(bytes.constData(), bytes.size());
+}
+
+}
+
+class TestGb18030 : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void decode_data();
+    void decode();
+    void asciiRunsAroundMultiByte();
+};
+
+void TestGb18030::decode_data()
+{
+    QTest::addColumn<QByteArray>("bytes");
+    QTest::addColumn<QString>("expected");
+
+    // 期望值与Python的gb18030编解码器一致
+    QTest::newRow("ascii") << QByteArray("a,b") << QStringLiteral("a,b");
+    QTest::newRow("two-byte") << QByteArray("\xD6\xD0\xCE\xC4") << fromUnits({0x4E2D, 0x6587});
+    QTest::newRow("four-byte first") << QByteArray("\x81\x30\x81\x30") << fromUnits({0x0080});
+    QTest::newRow("four-byte BMP") << QByteArray("\x82\x35\x8F\x33") << fromUnits({0x9FA6});
+    QTest::newRow("four-byte last BMP") << QByteArray("\x84\x31\xA4\x39") << fromUnits({0xFFFF});
+    QTest::newRow("supplementary first") << QByteArray("\x90\x30\x81\x30") << fromUnits({0xD800, 0xDC00});
+    QTest::newRow("supplementary U+20000") << QByteArray("\x95\x32\x82\x36") << fromUnits({0xD840, 0xDC00});
+    QTest::newRow("supplementary last") << QByteArray("\xE3\x32\x9A\x35") << fromUnits({0xDBFF, 0xDFFF});
+    // 无效或截断的序列输出U+FFFD，从下一个字节重新同步
+    QTest::newRow("truncated four-byte") << QByteArray("\x81\x30\x81") << fromUnits({0xFFFD, '0', 0xFFFD});
+    QTest::newRow("past last BMP") << QByteArray("\x84\x31\xA5\x30") << fromUnits({0xFFFD, '1', 0xFFFD, '0'});
+    QTest::newRow("invalid lead") << QByteArray("\x80\xFF") << fromUnits({0xFFFD, 0xFFFD});
+}
+
+void TestGb18030::decode()
+{
+    QFETCH(QByteArray, bytes);
+    QFETCH(QString, expected);
+    QCOMPARE(::decode(bytes), expected);
+}
+
+void TestGb18030::asciiRunsAroundMultiByte()
+{
+    // 向量化的ASCII扩展每次处理16或32字节，把多字节序列移过这些块边界
+    for (int prefix = 0; prefix <= 70; ++prefix) {
+        const QByteArray bytes = QByteArray(prefix, 'a') + "\x90\x30\x81\x30" + QByteArray(40, 'b') + "\xD6\xD0";
+        const QString expected = QString(prefix, QLatin1Char('a')) + fromUnits({0xD800, 0xDC00})
+                                 + QString(40, QLatin1Char('b')) + fromUnits({0x4E2D});
+        QCOMPARE(::decode(bytes), expected);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestGb18030)
+
+#include "tst_gb18030.moc"
@@ -0,0 +1,128 @@
+#include <QtTest>
+#include "csvreader.h"
+#include "rowblock.h"
+#include "rowblockpool.h"
+#include "textdecoder.h"
+
+namespace {
+
+QSharedPointer<RowBlock> filledBlock(const QByteArrayList &records, const QVector<int> &columns = QVector<int>())
+{
+    QSharedPointer<RowBlock> block = RowBlockPool::instance().acquire();
+    block->setEncoding(Encoding::UTF8);
+    block->setColumns(columns);
+    QVector<FieldSpan> spans;
+    for (const QByteArray &record : records) {
+        block->appendRecord(record.constData(), record.size(), ',', spans);
+    }
+    return block;
+}
+
+}
+
+class TestRowBlock : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void appendAndDecode();
+    void projection();
+    void recycledBlockIsEmpty();
+    void poolReusesBlocks();
+    void restoreRoundTrip();
+    void restoreRejectsTruncatedBytes();
+
+private:
+    TextDecoder m_decoder;
+};
+
+void TestRowBlock::init()
+{
+    m_decoder.setEncoding(Encoding::UTF8);
+}
+
+void TestRowBlock::appendAndDecode()
+{
+    const QSharedPointer<RowBlock> block = filledBlock({"a,\"b,c\"\r\n", "1,\"x\"\"y\",\xE4\xB8\xAD"});
+    QCOMPARE(block->rowCount(), 2);
+    QCOMPARE(block->field(0, 0, m_decoder), QStringLiteral("a"));
+    QCOMPARE(block->field(0, 1, m_decoder), QStringLiteral("b,c"));
+    // 第一行只有两列，后面的行增加的列在第一行中不存在
+    QVERIFY(!block->hasField(0, 2));
+    QCOMPARE(block->field(1, 1, m_decoder), QStringLiteral("x\"y"));
+    QCOMPARE(block->field(1, 2, m_decoder), QString::fromUtf8("\xE4\xB8\xAD"));
+}
+
+void TestRowBlock::projection()
+{
+    const QSharedPointer<RowBlock> block = filledBlock({"a,b,c", "d"}, {0, 2});
+    QVERIFY(!block->hasField(0, 1));
+    QCOMPARE(block->field(0, 0, m_decoder), QStringLiteral("a"));
+    QCOMPARE(block->field(0, 2, m_decoder), QStringLiteral("c"));
+    QCOMPARE(block->field(1, 0, m_decoder), QStringLiteral("d"));
+    QVERIFY(!block->hasField(1, 2));
+}
+
+void TestRowBlock::recycledBlockIsEmpty()
+{
+    RowBlockPool &pool = RowBlockPool::instance();
+    filledBlock({"a,b,c,d,e"}, {1, 3}).clear(); // 最后一个引用释放，块回到池中
+    QVERIFY(pool.freeCount() > 0);
+
+    const qint64 reuses = pool.reuses();
+    const QSharedPointer<RowBlock> block = pool.acquire();
+    QCOMPARE(pool.reuses(), reuses + 1);
+    QVERIFY(block->isEmpty());
+    QVERIFY(block->columns().isEmpty());
+
+    // 上一次填充的列数和投影都不能带到新的内容中
+    block->setEncoding(Encoding::UTF8);
+    QVector<FieldSpan> spans;
+    block->appendRecord("x,y", 3, ',', spans);
+    QCOMPARE(block->field(0, 1, m_decoder), QStringLiteral("y"));
+    QVERIFY(!block->hasField(0, 2));
+}
+
+void TestRowBlock::poolReusesBlocks()
+{
+    // 按相同行数反复取块、填充、释放时不再新分配块
+    RowBlockPool &pool = RowBlockPool::instance();
+    filledBlock({"warm,up"}).clear();
+    const qint64 allocations = pool.allocations();
+    for (int i = 0; i < 100; ++i) {
+        filledBlock({"a,b", "c,d"}).clear();
+    }
+    QCOMPARE(pool.allocations(), allocations);
+}
+
+void TestRowBlock::restoreRoundTrip()
+{
+    for (const QVector<int> &columns : {QVector<int>(), QVector<int>{1}}) {
+        const QSharedPointer<RowBlock> source = filledBlock({"a,\"b\"\"c\",", "\xE4\xB8\xAD,2"}, columns);
+        const QSharedPointer<RowBlock> target = RowBlockPool::instance().acquire();
+        QVERIFY(target->restore(source->toBytes()));
+        QCOMPARE(target->rowCount(), source->rowCount());
+        QCOMPARE(target->columns(), source->columns());
+        for (int row = 0; row < source->rowCount(); ++row) {
+            for (int column = 0; column < 4; ++column) {
+                QCOMPARE(target->hasField(row, column), source->hasField(row, column));
+                QCOMPARE(target->field(row, column, m_decoder), source->field(row, column, m_decoder));
+            }
+        }
+    }
+}
+
+void TestRowBlock::restoreRejectsTruncatedBytes()
+{
+    const QByteArray bytes = filledBlock({"a,b", "c,d"})->toBytes();
+    const QSharedPointer<RowBlock> target = RowBlockPool::instance().acquire();
+    QVERIFY(!target->restore(bytes.left(bytes.size() - 1)));
+    QVERIFY(target->isEmpty());
+    QVERIFY(!target->restore(bytes + "x"));
+    QVERIFY(target->isEmpty());
+}
+
+QTEST_APPLESS_MAIN(TestRowBlock)
+
+#include "tst_rowblock.moc"
@@ -0,0 +1,150 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include "rowindexer.h"
+
+namespace {
+
+// 逐字节扫描的参考实现：引号外的换行符之后是记录起始
+QVector<qint64> referenceRecordStarts(const QByteArray &data, qint64 baseOffset, bool inQuotes)
+{
+    QVector<qint64> starts;
+    for (int i = 0; i < data.size(); ++i) {
+        if (data.at(i) == '"') {
+            inQuotes = !inQuotes;
+        } else if (data.at(i) == '\n' && !inQuotes) {
+            starts.append(baseOffset + i + 1);
+        }
+    }
+    return starts;
+}
+
+QVector<qint64> recordStarts(const QByteArray &data, qint64 baseOffset, bool inQuotes)
+{
+    QVector<qint64> starts;
+    RowIndexer::findRecordStarts(data.constData(), data.size(), baseOffset, inQuotes, starts);
+    return starts;
+}
+
+// 固定种子的随机数据，引号和换行符密集，长度跨越多个64字节块
+QByteArray randomCsv(QRandomGenerator &random, int length)
+{
+    static const char alphabet[] = {'a', ',', '"', '"', '\n', '\n', '\r', ' '};
+    QByteArray data;
+    for (int i = 0; i < length; ++i) {
+        data.append(alphabet[random.bounded(int(sizeof(alphabet)))]);
+    }
+    return data;
+}
+
+}
+
+class TestRowIndexer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void findRecordStarts_data();
+    void findRecordStarts();
+    void matchesReference();
+    void scanChunkBothStates();
+    void splitAtEveryOffset();
+    void findRowStarts();
+    void implementationName();
+};
+
+void TestRowIndexer::findRecordStarts_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QVector<qint64>>("expected");
+
+    QTest::newRow("LF") << QByteArray("a,b\nc,d\n") << QVector<qint64>{4, 8};
+    QTest::newRow("CRLF") << QByteArray("a,b\r\nc,d\r\n") << QVector<qint64>{5, 10};
+    QTest::newRow("quoted line break") << QByteArray("\"x\ny\",1\nz\n") << QVector<qint64>{8, 10};
+    QTest::newRow("escaped quote before line break") << QByteArray("\"a\"\"\nb\"\nc") << QVector<qint64>{8};
+    // 引号区域跨过64字节块边界，块内的换行符都不是记录边界
+    QTest::newRow("quoted across block") << QByteArray(60, 'x') + "\"" + QByteArray(10, '\n') + "\"\n"
+                                         << QVector<qint64>{73};
+}
+
+void TestRowIndexer::findRecordStarts()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QVector<qint64>, expected);
+    QCOMPARE(recordStarts(data, 0, false), expected);
+}
+
+void TestRowIndexer::matchesReference()
+{
+    QRandomGenerator random(20240612);
+    for (int round = 0; round < 1000; ++round) {
+        const QByteArray data = randomCsv(random, random.bounded(400));
+        const qint64 base = random.bounded(1 << 20);
+        for (bool inQuotes : {false, true}) {
+            bool state = inQuotes;
+            QVector<qint64> starts;
+            RowIndexer::findRecordStarts(data.constData(), data.size(), base, state, starts);
+            QCOMPARE(starts, referenceRecordStarts(data, base, inQuotes));
+            QCOMPARE(state, inQuotes != (data.count('"') % 2 == 1));
+        }
+    }
+}
+
+void TestRowIndexer::scanChunkBothStates()
+{
+    // 两组结果分别等于块起点在引号外/引号内时顺序扫描的结果
+    QRandomGenerator random(20240613);
+    for (int round = 0; round < 500; ++round) {
+        const QByteArray data = randomCsv(random, random.bounded(400));
+        ChunkScanResult result;
+        RowIndexer::scanChunk(data.constData(), data.size(), 1000, result);
+        QCOMPARE(result.rowStartsIfOutside, referenceRecordStarts(data, 1000, false));
+        QCOMPARE(result.rowStartsIfInside, referenceRecordStarts(data, 1000, true));
+        QCOMPARE(result.togglesQuoteState, data.count('"') % 2 == 1);
+    }
+}
+
+void TestRowIndexer::splitAtEveryOffset()
+{
+    // 在任意位置把数据分成两块，带着引号状态依次扫描，结果与整体扫描相同
+    QRandomGenerator random(20240614);
+    const QByteArray data = randomCsv(random, 200);
+    const QVector<qint64> whole = recordStarts(data, 0, false);
+    for (int split = 0; split <= data.size(); ++split) {
+        bool inQuotes = false;
+        QVector<qint64> starts;
+        RowIndexer::findRecordStarts(data.constData(), split, 0, inQuotes, starts);
+        RowIndexer::findRecordStarts(data.constData() + split, data.size() - split, split, inQuotes, starts);
+        QCOMPARE(starts, whole);
+    }
+}
+
+void TestRowIndexer::findRowStarts()
+{
+    // 不区分引号，每个换行符之后都是一行的起始
+    QRandomGenerator random(20240615);
+    for (int round = 0; round < 200; ++round) {
+        const QByteArray data = randomCsv(random, random.bounded(400));
+        QVector<qint64> expected;
+        for (int i = 0; i < data.size(); ++i) {
+            if (data.at(i) == '\n') {
+                expected.append(i + 1);
+            }
+        }
+        QVector<qint64> starts;
+        RowIndexer::findRowStarts(data.constData(), data.size(), 0, starts);
+        QCOMPARE(starts, expected);
+    }
+}
+
+void TestRowIndexer::implementationName()
+{
+    if (qEnvironmentVariableIsSet("CSV_FORCE_SCALAR")) {
+        QCOMPARE(RowIndexer::implementationName(), QStringLiteral("Scalar/Scalar"));
+    } else {
+        QVERIFY(!RowIndexer::implementationName().isEmpty());
+    }
+}
+
+QTEST_APPLESS_MAIN(TestRowIndexer)
+
+#include "tst_rowindexer.moc"
@@ -0,0 +1,101 @@
+#include <QtTest>
+#include <QThread>
+#include <QSharedPointer>
+#include "spscqueue.h"
+
+class TestSpscQueue : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fifoAndCapacity();
+    void wrapAround();
+    void popReleasesSlot();
+    void producerConsumerThreads();
+};
+
+void TestSpscQueue::fifoAndCapacity()
+{
+    SpscQueue<int, 4> queue;
+    int value = 0;
+    QVERIFY(!queue.pop(&value));
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(queue.push(i));
+    }
+    QVERIFY(!queue.push(4)); // 已满
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(queue.pop(&value));
+        QCOMPARE(value, i);
+    }
+    QVERIFY(!queue.pop(&value));
+}
+
+void TestSpscQueue::wrapAround()
+{
+    // 下标自由递增，反复经过容量的整数倍时顺序不变
+    SpscQueue<int, 4> queue;
+    int next = 0;
+    int expected = 0;
+    for (int round = 0; round < 1000; ++round) {
+        const int batch = round % 4 + 1;
+        for (int i = 0; i < batch; ++i) {
+            QVERIFY(queue.push(next++));
+        }
+        for (int i = 0; i < batch; ++i) {
+            int value = -1;
+            QVERIFY(queue.pop(&value));
+            QCOMPARE(value, expected++);
+        }
+    }
+}
+
+void TestSpscQueue::popReleasesSlot()
+{
+    // 取出后槽位不再持有元素，读取结果中的行块引用能及时回到缓冲池
+    SpscQueue<QSharedPointer<int>, 2> queue;
+    QSharedPointer<int> value(new int(42));
+    const QWeakPointer<int> weak = value;
+    QVERIFY(queue.push(value));
+    value.clear();
+    QSharedPointer<int> popped;
+    QVERIFY(queue.pop(&popped));
+    QCOMPARE(*popped, 42);
+    popped.clear();
+    QVERIFY(weak.isNull());
+}
+
+void TestSpscQueue::producerConsumerThreads()
+{
+    constexpr int Count = 200000;
+    SpscQueue<int, 64> queue;
+    QThread *producer = QThread::create([&queue]() {
+        for (int i = 0; i < Count; ++i) {
+            while (!queue.push(i)) {
+                QThread::yieldCurrentThread();
+            }
+        }
+    });
+    producer->start();
+
+    // 顺序错误时也要取完，生产者才不会一直等待空位
+    int received = 0;
+    int outOfOrder = 0;
+    while (received < Count) {
+        int value = -1;
+        if (!queue.pop(&value)) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        if (value != received) {
+            outOfOrder++;
+        }
+        received++;
+    }
+    producer->wait();
+    delete producer;
+    QCOMPARE(outOfOrder, 0);
+}
+
+QTEST_APPLESS_MAIN(TestSpscQueue)
+
+#include "tst_spscqueue.moc"
@@ -0,0 +1,196 @@
+#include "textdecoder.h"
+#include "csvreader.h"
+#include "cpufeatures.h"
+#include "gb18030.h"
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+#include <QTextCodec>
+#endif
+
+#if defined(CSV_SIMD_X86)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using IsAsciiFn = bool (*)(const char *, qint64);
+
+bool isAsciiScalar(const char *data, qint64 size)
+{
+    for (qint64 i = 0; i < size; ++i) {
+        if (static_cast<uchar>(data[i]) & 0x80) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(CSV_SIMD_X86)
+
+CSV_TARGET("sse2")
+bool isAsciiSse2(const char *data, qint64 size)
+{
+    qint64 i = 0;
+    // 每次检查64字节：先把4个16字节块按位或，再一次取出所有字节的最高位
+    for (; i + 64 <= size; i += 64) {
+        const __m128i *p = reinterpret_cast<const __m128i *>(data + i);
+        const __m128i merged = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                            _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        if (_mm_movemask_epi8(merged)) {
+            return false;
+        }
+    }
+    return isAsciiScalar(data + i, size - i);
+}
+
+CSV_TARGET("avx2")
+bool isAsciiAvx2(const char *data, qint64 size)
+{
+    qint64 i = 0;
+    for (; i + 64 <= size; i += 64) {
+        const __m256i *p = reinterpret_cast<const __m256i *>(data + i);
+        const __m256i merged = _mm256_or_si256(_mm256_loadu_si256(p), _mm256_loadu_si256(p + 1));
+        if (_mm256_movemask_epi8(merged)) {
+            return false;
+        }
+    }
+    return isAsciiScalar(data + i, size - i);
+}
+
+#endif
+
+IsAsciiFn resolveIsAscii()
+{
+#if defined(CSV_SIMD_X86)
+    if (CpuFeatures::hasAvx2()) {
+        return isAsciiAvx2;
+    }
+    if (CpuFeatures::hasSse2()) {
+        return isAsciiSse2;
+    }
+#endif
+    return isAsciiScalar;
+}
+
+// 首次使用时选定实现，之后直接调用函数指针
+IsAsciiFn isAsciiImpl()
+{
+    static const IsAsciiFn impl = resolveIsAscii();
+    return impl;
+}
+
+}
+
+TextDecoder::TextDecoder()
+    : m_encoding(Encoding::AutoDetect)
+    , m_codeUnit(CodeUnit::Byte)
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    , m_codec(nullptr)
+#endif
+{
+    setEncoding(Encoding::UTF8);
+}
+
+void TextDecoder::setEncoding(Encoding encoding)
+{
+    if (encoding == Encoding::AutoDetect) {
+        encoding = Encoding::UTF8;
+    }
+    if (encoding == m_encoding) {
+        return;
+    }
+    m_encoding = encoding;
+    m_codeUnit = codeUnitOf(encoding);
+
+    // GBK不经过Qt的编码转换，由Gb18030::toUnicode解码
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QStringConverter::Encoding converter = QStringConverter::Utf8;
+    switch (encoding) {
+    case Encoding::ASCII:
+        converter = QStringConverter::Latin1;
+        break;
+    case Encoding::UTF16LE:
+        converter = QStringConverter::Utf16LE;
+        break;
+    case Encoding::UTF16BE:
+        converter = QStringConverter::Utf16BE;
+        break;
+    default:
+        break;
+    }
+    m_decoder = QStringDecoder(converter, QStringConverter::Flag::Stateless);
+#else
+    switch (encoding) {
+    case Encoding::UTF16LE:
+        m_codec = QTextCodec::codecForName("UTF-16LE");
+        break;
+    case Encoding::UTF16BE:
+        m_codec = QTextCodec::codecForName("UTF-16BE");
+        break;
+    case Encoding::ASCII:
+        m_codec = QTextCodec::codecForName("ISO-8859-1");
+        break;
+    default:
+        m_codec = QTextCodec::codecForName("UTF-8");
+        break;
+    }
+#endif
+}
+
+Encoding TextDecoder::encoding() const
+{
+    return m_encoding;
+}
+
+CodeUnit TextDecoder::codeUnit() const
+{
+    return m_codeUnit;
+}
+
+CodeUnit TextDecoder::codeUnitOf(Encoding encoding)
+{
+    switch (encoding) {
+    case Encoding::UTF16LE:
+        return CodeUnit::Utf16LE;
+    case Encoding::UTF16BE:
+        return CodeUnit::Utf16BE;
+    default:
+        return CodeUnit::Byte;
+    }
+}
+
+QString TextDecoder::decode(const char *data, int size)
+{
+    if (m_codeUnit != CodeUnit::Byte) {
+        // UTF-16中的ASCII字符也含零字节，不能按Latin1转换；按当前字节序去掉BOM
+        if (size >= 2 && loadCodeUnit(data, m_codeUnit) == 0xFEFF) {
+            data += 2;
+            size -= 2;
+        }
+    } else {
+        // 纯ASCII在其余支持的编码中含义相同，直接按Latin1转换
+        if (isAsciiImpl()(data, size)) {
+            return QString::fromLatin1(data, size);
+        }
+        // 处理UTF-8 BOM
+        if (size >= 3 && data[0] == '\xEF' && data[1] == '\xBB' && data[2] == '\xBF') {
+            data += 3;
+            size -= 3;
+        }
+        if (m_encoding == Encoding::GBK) {
+            return Gb18030::toUnicode(data, size);
+        }
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return m_decoder.decode(QByteArrayView(data, size));
+#else
+    return m_codec->toUnicode(data, size);
+#endif
+}
+
+bool TextDecoder::isAscii(const char *data, qint64 size)
+{
+    if (!data || size <= 0) {
+        return true;
+    }
+    return isAsciiImpl()(data, size);
+}
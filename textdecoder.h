@@ -0,0 +1,60 @@
+#ifndef TEXTDECODER_H
+#define TEXTDECODER_H
+
+#include <QString>
+#include <QtGlobal>
+#include "codeunit.h"
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QStringDecoder>
+#else
+class QTextCodec;
+#endif
+
+enum class Encoding; // 定义见csvreader.h
+
+/**
+ * @class TextDecoder
+ * @brief 按文件编码把原始字节解码为QString，整个文件复用同一个解码器
+ *
+ * 编码在打开文件时确定一次，之后每个字段只做解码，不再检测编码。
+ * 纯ASCII的字段（CSV中的数字、日期等绝大多数字段）经向量化检查后直接按Latin1转换，跳过UTF-8校验。
+ * GBK/GB18030由查表实现的Gb18030解码，与系统区域设置无关；UTF-16LE/BE交给Qt的UTF-16解码器。
+ */
+class TextDecoder
+{
+public:
+    TextDecoder();
+
+    /**
+     * @brief 设置编码并重建解码器，AutoDetect按UTF-8处理
+     */
+    void setEncoding(Encoding encoding);
+    Encoding encoding() const;
+
+    /**
+     * @brief 当前编码的码元宽度，决定行索引和字段切分按字节还是按UTF-16码元扫描
+     */
+    CodeUnit codeUnit() const;
+    static CodeUnit codeUnitOf(Encoding encoding);
+
+    /**
+     * @brief 解码一段完整的文本（字段或记录），开头的BOM会被去掉
+     */
+    QString decode(const char *data, int size);
+
+    /**
+     * @brief 数据是否全部为ASCII字节（最高位均为0），按运行时检测到的指令集选择AVX2/SSE2实现
+     */
+    static bool isAscii(const char *data, qint64 size);
+
+private:
+    Encoding m_encoding;
+    CodeUnit m_codeUnit;
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QStringDecoder m_decoder; // 无状态模式：每次调用都是完整文本，不会把上个字段的残余字节带入下一个
+#else
+    QTextCodec *m_codec;
+#endif
+};
+
+#endif // TEXTDECODER_H
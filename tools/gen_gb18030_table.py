@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""生成 gb18030table.cpp：GB18030 双字节码表和四字节 BMP 区段表。
+
+数据取自 Python 自带的 gb18030 编解码器，在仓库根目录运行：
+    python3 tools/gen_gb18030_table.py > gb18030table.cpp
+"""
+
+LEADS = range(0x81, 0xFF)
+TRAILS = [t for t in range(0x40, 0xFF) if t != 0x7F]
+
+
+def two_byte_table():
+    table = []
+    for lead in LEADS:
+        for trail in TRAILS:
+            try:
+                text = bytes([lead, trail]).decode('gb18030')
+                table.append(ord(text) if len(text) == 1 and ord(text) <= 0xFFFF else 0)
+            except UnicodeDecodeError:
+                table.append(0)
+    return table
+
+
+def four_byte_ranges():
+    # 四字节序列 81308130..8431A439 线性编号 0..39419 映射到 BMP，按连续区段压缩
+    ranges = []
+    for linear in range(39420):
+        b4 = 0x30 + linear % 10
+        b3 = 0x81 + linear // 10 % 126
+        b2 = 0x30 + linear // 1260 % 10
+        b1 = 0x81 + linear // 12600
+        try:
+            code = ord(bytes([b1, b2, b3, b4]).decode('gb18030'))
+        except UnicodeDecodeError:
+            continue
+        if ranges and ranges[-1][0] + ranges[-1][2] == linear and ranges[-1][1] + ranges[-1][2] == code:
+            ranges[-1][2] += 1
+        else:
+            ranges.append([linear, code, 1])
+    return ranges
+
+
+def main():
+    table = two_byte_table()
+    ranges = four_byte_ranges()
+    print('// 本文件由 tools/gen_gb18030_table.py 生成，请勿手工修改')
+    print('#include "gb18030.h"')
+    print()
+    print('namespace Gb18030 {')
+    print()
+    print('// 双字节码表：下标 (首字节-0x81)*190 + 尾字节序号（0x40~0x7E、0x80~0xFE），0表示未定义')
+    print('const quint16 TwoByteTable[TwoByteTableSize] = {')
+    for i in range(0, len(table), 16):
+        print('    ' + ', '.join('0x%04X' % v for v in table[i:i + 16]) + ',')
+    print('};')
+    print()
+    print('// 四字节BMP区段：{起始线性编号, 起始码位}，区段内线性编号与码位同步递增')
+    print('const FourByteRange FourByteRanges[FourByteRangeCount] = {')
+    for linear, code, _ in ranges:
+        print('    {%d, 0x%04X},' % (linear, code))
+    print('};')
+    print()
+    print('}')
+    import sys
+    print('// two-byte entries: %d, four-byte ranges: %d' % (len(table), len(ranges)), file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()